@@ -0,0 +1,120 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    act_bench.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Accuracy and throughput of the activation tiers (inc/activation.h) against
+ double precision libm, on the host.
+
+   gcc -O2 -Iinc host/act_bench.c src/activation.c -lm -o act_bench
+   ./act_bench
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "activation.h"
+
+#define N_POINTS    400001      // evaluation grid over [X_MIN, X_MAX]
+#define X_MIN       -20.0
+#define X_MAX       20.0
+#define REPEAT      20          // passes over the grid for the timing
+#define SOFTMAX_N   10
+
+static const char *tier_names[ACT_N_TIERS] = { "libm", "poly", "lut" };
+
+typedef float (*act_fn_t)(float x, act_tier_t tier);
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double ref_exp(double x) { return exp(x); }
+static double ref_sigmoid(double x) { return 1.0 / (1.0 + exp(-x)); }
+static double ref_tanh(double x) { return tanh(x); }
+
+static void bench(const char *name, act_fn_t fn, double (*ref)(double), int relative)
+{
+  for (int tier = 0; tier < ACT_N_TIERS; tier++) {
+    double max_err = 0.0;
+    for (int i = 0; i < N_POINTS; i++) {
+      float x = (float)(X_MIN + (X_MAX - X_MIN) * i / (N_POINTS - 1));
+      double expected = ref((double)x);
+      double err = fabs((double)fn(x, tier) - expected);
+      if (relative) err /= expected;
+      if (err > max_err) max_err = err;
+    }
+
+    volatile float sink = 0.0f;
+    double t0 = now_s();
+    for (int r = 0; r < REPEAT; r++) {
+      for (int i = 0; i < N_POINTS; i++) {
+        sink += fn((float)(X_MIN + (X_MAX - X_MIN) * i / (N_POINTS - 1)), tier);
+      }
+    }
+    double ns = (now_s() - t0) * 1e9 / ((double)REPEAT * N_POINTS);
+    printf("%-8s %-5s %8.2f ns/call %10.3g max %s error\n", name, tier_names[tier], ns, max_err,
+           relative ? "relative" : "absolute");
+  }
+}
+
+static void bench_softmax(void)
+{
+  for (int tier = 0; tier < ACT_N_TIERS; tier++) {
+    double max_err = 0.0, max_sum_err = 0.0;
+    float in[SOFTMAX_N], out[SOFTMAX_N];
+    uint32_t seed = 1;
+    for (int v = 0; v < 20000; v++) {
+      double max_in = -INFINITY, sum = 0.0, sum_out = 0.0;
+      for (int i = 0; i < SOFTMAX_N; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        in[i] = (float)((int32_t)seed) / 2147483648.0f * 30.0f;  // logits in [-30, 30]
+        if (in[i] > max_in) max_in = in[i];
+      }
+      act_softmax(in, out, SOFTMAX_N, tier);
+      for (int i = 0; i < SOFTMAX_N; i++) sum += exp(in[i] - max_in);
+      for (int i = 0; i < SOFTMAX_N; i++) {
+        double err = fabs(out[i] - exp(in[i] - max_in) / sum);
+        if (err > max_err) max_err = err;
+        sum_out += out[i];
+      }
+      if (fabs(sum_out - 1.0) > max_sum_err) max_sum_err = fabs(sum_out - 1.0);
+    }
+    // logits that overflow expf() without the max subtraction
+    float big[3] = { 1000.0f, 999.0f, -1000.0f };
+    act_softmax(big, out, 3, tier);
+    printf("softmax  %-5s %10.3g max absolute error %10.3g max |sum - 1|, [1000, 999, -1000] -> [%.4f %.4f %.4f]\n",
+           tier_names[tier], max_err, max_sum_err, out[0], out[1], out[2]);
+  }
+}
+
+int main(void)
+{
+  bench("exp", act_exp, ref_exp, 1);
+  bench("sigmoid", act_sigmoid, ref_sigmoid, 0);
+  bench("tanh", act_tanh, ref_tanh, 0);
+  bench_softmax();
+  return 0;
+}
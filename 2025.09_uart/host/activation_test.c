@@ -0,0 +1,133 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    activation_test.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ The activation tiers of inc/activation.h against double precision libm.
+
+ Checks the error bounds documented in activation.h for every tier over
+ [-20, 20], the behaviour outside it (no overflow, no NaN, sigmoid and
+ tanh saturate to their limits and stay monotonic) and softmax on large,
+ equal and single inputs, in place. act_bench prints the measured errors
+ and the cost; this test only asserts. Exits non-zero on failure.
+
+   gcc -O2 -Wall -Wextra -Iinc host/activation_test.c src/activation.c -lm -o activation_test
+   ./activation_test
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "activation.h"
+#include "check.h"
+
+#define N_POINTS    40001       // grid over [X_MIN, X_MAX]
+#define X_MIN       -20.0
+#define X_MAX       20.0
+#define MARGIN      1.1         // on the documented bounds, for libm differences between hosts
+
+static const char *tier_names[ACT_N_TIERS] = { "libm", "poly", "lut" };
+
+// Max errors over [-20, 20], the table of activation.h
+static const double bound_exp[ACT_N_TIERS]     = { 6e-8, 1.2e-6, 1.6e-5 };   // relative
+static const double bound_sigmoid[ACT_N_TIERS] = { 9e-8, 1.1e-7, 3.8e-6 };   // absolute
+static const double bound_tanh[ACT_N_TIERS]    = { 9e-8, 2.1e-7, 7.4e-6 };
+static const double bound_softmax[ACT_N_TIERS] = { 3e-7, 3e-7, 3.7e-6 };
+
+static void test_bounds(act_tier_t tier)
+{
+  double err_exp = 0, err_sigmoid = 0, err_tanh = 0;
+  float prev_sigmoid = 0.0f, prev_tanh = -1.0f;
+  for (int i = 0; i < N_POINTS; i++) {
+    float x = (float)(X_MIN + (X_MAX - X_MIN) * i / (N_POINTS - 1));
+    double e = exp((double)x);
+    err_exp = fmax(err_exp, fabs(act_exp(x, tier) - e) / e);
+    float s = act_sigmoid(x, tier), t = act_tanh(x, tier);
+    err_sigmoid = fmax(err_sigmoid, fabs(s - 1.0 / (1.0 + exp(-(double)x))));
+    err_tanh = fmax(err_tanh, fabs(t - tanh((double)x)));
+    CHECK(s >= prev_sigmoid && t >= prev_tanh, "%s: not monotonic at %g", tier_names[tier], (double)x);
+    prev_sigmoid = s;
+    prev_tanh = t;
+  }
+  CHECK(err_exp <= bound_exp[tier] * MARGIN, "%s exp: %.3g > %.3g", tier_names[tier], err_exp, bound_exp[tier]);
+  CHECK(err_sigmoid <= bound_sigmoid[tier] * MARGIN, "%s sigmoid: %.3g > %.3g", tier_names[tier], err_sigmoid, bound_sigmoid[tier]);
+  CHECK(err_tanh <= bound_tanh[tier] * MARGIN, "%s tanh: %.3g > %.3g", tier_names[tier], err_tanh, bound_tanh[tier]);
+
+  // softmax of random 10-vectors against a double-precision softmax
+  uint32_t seed = 7;
+  double err_softmax = 0;
+  for (int round = 0; round < 2000; round++) {
+    float in[10], out[10];
+    double ref[10], max = -1e300, sum = 0;
+    for (int k = 0; k < 10; k++) {
+      seed = seed * 1664525u + 1013904223u;
+      in[k] = (float)(X_MIN + (X_MAX - X_MIN) * (seed >> 8) / (double)(1 << 24));
+      max = fmax(max, in[k]);
+    }
+    for (int k = 0; k < 10; k++) sum += ref[k] = exp(in[k] - max);
+    act_softmax(in, out, 10, tier);
+    for (int k = 0; k < 10; k++) err_softmax = fmax(err_softmax, fabs(out[k] - ref[k] / sum));
+  }
+  CHECK(err_softmax <= bound_softmax[tier] * MARGIN, "%s softmax: %.3g > %.3g", tier_names[tier], err_softmax, bound_softmax[tier]);
+}
+
+static void test_limits(act_tier_t tier)
+{
+  const float xs[] = { -1000.0f, -200.0f, -100.0f, -88.0f, 88.0f, 100.0f, 200.0f, 1000.0f };
+  for (unsigned i = 0; i < sizeof(xs) / sizeof(xs[0]); i++) {
+    float e = act_exp(xs[i], tier), s = act_sigmoid(xs[i], tier), t = act_tanh(xs[i], tier);
+    CHECK(!isnan(e) && e >= 0.0f, "%s exp(%g) = %g", tier_names[tier], (double)xs[i], (double)e);
+    CHECK(xs[i] > 0 ? s == 1.0f : s >= 0.0f && s < 1e-30f, "%s sigmoid(%g) = %g", tier_names[tier], (double)xs[i], (double)s);
+    CHECK(t == (xs[i] > 0 ? 1.0f : -1.0f), "%s tanh(%g) = %g", tier_names[tier], (double)xs[i], (double)t);
+  }
+  CHECK(act_sigmoid(0.0f, tier) == 0.5f || fabsf(act_sigmoid(0.0f, tier) - 0.5f) < 1e-7f, "%s sigmoid(0)", tier_names[tier]);
+  CHECK(fabsf(act_tanh(0.0f, tier)) < 1e-7f, "%s tanh(0)", tier_names[tier]);
+
+  // softmax: no overflow on large logits, in place
+  float v[3] = { 1000.0f, 999.0f, -1000.0f };
+  act_softmax(v, v, 3, tier);
+  CHECK(fabsf(v[0] - 0.731058579f) < 4e-6f && fabsf(v[1] - 0.268941421f) < 4e-6f && v[2] >= 0.0f && v[2] < 1e-30f,
+        "%s softmax(1000, 999, -1000) = %g %g %g", tier_names[tier], (double)v[0], (double)v[1], (double)v[2]);
+  float flat[5] = { -3.0f, -3.0f, -3.0f, -3.0f, -3.0f };
+  act_softmax(flat, flat, 5, tier);
+  for (int k = 0; k < 5; k++) CHECK(fabsf(flat[k] - 0.2f) < 1e-7f, "%s softmax of equal inputs", tier_names[tier]);
+  float one = 42.0f;
+  act_softmax(&one, &one, 1, tier);
+  CHECK(one == 1.0f, "%s softmax of one input = %g", tier_names[tier], (double)one);
+  float untouched = 3.0f;
+  act_softmax(&untouched, &untouched, 0, tier);
+  CHECK(untouched == 3.0f, "%s softmax of nothing must not write", tier_names[tier]);
+}
+
+int main(void)
+{
+  for (int tier = 0; tier < ACT_N_TIERS; tier++) {
+    test_bounds((act_tier_t)tier);
+    test_limits((act_tier_t)tier);
+  }
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("activation_test: all checks passed\n");
+  return EXIT_SUCCESS;
+}
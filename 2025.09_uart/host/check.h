@@ -0,0 +1,50 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    check.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Checks shared by the host tests in this directory.
+
+ CHECK() counts every failure in `failures` and prints the first
+ CHECK_MAX_PRINTED of them; a test exits non-zero if failures != 0.
+ CHECK_NEAR() evaluates its arguments once, so it can wrap the call under test.
+*/
+
+#ifndef __HOST_CHECK_H
+#define __HOST_CHECK_H
+
+#include <stdio.h>
+
+#define CHECK_MAX_PRINTED 20
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+  if (!(cond) && failures++ < CHECK_MAX_PRINTED) { printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } \
+} while (0)
+
+#define CHECK_NEAR(got, expected, tol, what) do { \
+  double got_ = (got), expected_ = (expected); \
+  double error_ = got_ > expected_ ? got_ - expected_ : expected_ - got_; \
+  CHECK(error_ <= (tol), "%s: %.9g, expected %.9g", what, got_, expected_); \
+} while (0)
+
+#endif
@@ -0,0 +1,171 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    decoder_test.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ The built-in decoder tables of inc/networks.h against hand-computed values.
+
+ One test per table: DroNet (int32, runtime scale and zero point per head,
+ steering clamped to [-1, 1]), the classifier (int8 logits, constant scale,
+ softmax) and the depth grid (int8, constant zero point, clamped to
+ [0, DEPTH_GRID_RANGE]). The raw outputs are written byte by byte, little
+ endian, as they arrive on the link. A last table covers the int16 dtype
+ and the sigmoid and tanh activations. Exits non-zero on failure.
+
+   gcc -O2 -Wall -Wextra -Iinc host/decoder_test.c src/activation.c -lm -o decoder_test
+   ./decoder_test
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "networks.h"
+#include "check.h"
+
+#define TOL   1e-6f   // ACT_POLY softmax error is 3e-7 (activation.h)
+
+static void put_le32(uint8_t *p, int32_t value)
+{
+  uint32_t u = (uint32_t)value;
+  p[0] = (uint8_t)u; p[1] = (uint8_t)(u >> 8); p[2] = (uint8_t)(u >> 16); p[3] = (uint8_t)(u >> 24);
+}
+
+static void test_dronet(void)
+{
+  CHECK(dronet_HEADS == 2 && dronet_BYTES == 8, "dronet layout: %d heads, %d bytes", dronet_HEADS, dronet_BYTES);
+  CHECK(dronet_heads[0].dtype == DECODE_INT32 && dronet_heads[0].scale == DECODE_RUNTIME_SCALE &&
+        dronet_heads[1].offset == 4, "dronet table");
+
+  uint8_t raw[dronet_BYTES];
+  dronet_output_t out;
+  decode_quant_t quant[dronet_HEADS] = { { 0.001f, 500 }, { 0.00125f, -100 } };
+
+  // (-300 - 500) * 0.001 = -0.8; (700 + 100) * 0.00125 = 1.0
+  put_le32(&raw[0], -300);
+  put_le32(&raw[4], 700);
+  dronet_decode(raw, quant, &out);
+  CHECK_NEAR(out.steering[0], -0.8f, TOL, "dronet steering");
+  CHECK_NEAR(out.collision[0], 1.0f, TOL, "dronet collision");
+
+  // steering (2000 - 500) * 0.001 = 1.5 is clamped to 1; collision has no clamp: (-900 + 100) * 0.00125 = -1.0
+  put_le32(&raw[0], 2000);
+  put_le32(&raw[4], -900);
+  dronet_decode(raw, quant, &out);
+  CHECK_NEAR(out.steering[0], 1.0f, 0.0f, "dronet steering clamp");
+  CHECK_NEAR(out.collision[0], -1.0f, TOL, "dronet collision unclamped");
+
+  // the full int32 range, a new table without a reflash: (INT32_MIN - 0) * 1e-9 = -2.147483648, clamped to -1
+  decode_quant_t wide[dronet_HEADS] = { { 1e-9f, 0 }, { 1e-9f, -1 } };
+  put_le32(&raw[0], INT32_MIN);
+  put_le32(&raw[4], INT32_MAX - 1);  // (2^31 - 2 + 1) * 1e-9
+  dronet_decode(raw, wide, &out);
+  CHECK_NEAR(out.steering[0], -1.0f, 0.0f, "dronet steering lower clamp");
+  CHECK_NEAR(out.collision[0], 2.147483647f, 1e-6f, "dronet collision full range");
+}
+
+static void test_classifier(void)
+{
+  CHECK(classifier_HEADS == 1 && classifier_BYTES == CLASSIFIER_CLASSES, "classifier layout");
+  CHECK(CLASSIFIER_CLASSES == 4 && CLASSIFIER_SCALE == 0.125f, "the expected values below assume 4 classes, 1/8 per LSB");
+
+  // logits 8, 0, -8, 16 LSB = 1, 0, -1, 2; softmax = e^x / (e + 1 + 1/e + e^2)
+  uint8_t raw[classifier_BYTES] = { 8, 0, (uint8_t)-8, 16 };
+  const float expected[4] = { 0.236882818f, 0.087144319f, 0.032058603f, 0.643914260f };
+  classifier_output_t out;
+  classifier_decode(raw, NULL, &out);
+  float sum = 0.0f;
+  for (int i = 0; i < 4; i++) {
+    CHECK_NEAR(out.probs[i], expected[i], TOL, "classifier softmax");
+    sum += out.probs[i];
+  }
+  CHECK_NEAR(sum, 1.0f, TOL, "classifier sum");
+
+  // equal logits: uniform, even at the ends of the int8 range
+  uint8_t flat[classifier_BYTES] = { 0x80, 0x80, 0x80, 0x80 };
+  classifier_decode(flat, NULL, &out);
+  for (int i = 0; i < 4; i++) CHECK_NEAR(out.probs[i], 0.25f, TOL, "classifier uniform");
+
+  // -128 vs 127 LSB: 31.875 apart, the small ones underflow towards e^-31.875 = 1.43e-14
+  uint8_t peak[classifier_BYTES] = { 0x80, 0x7F, 0x80, 0x80 };
+  classifier_decode(peak, NULL, &out);
+  CHECK_NEAR(out.probs[1], 1.0f, TOL, "classifier peak");
+  CHECK(out.probs[0] >= 0.0f && out.probs[0] < 1e-13f, "classifier tail %g", (double)out.probs[0]);
+}
+
+static void test_depth(void)
+{
+  CHECK(depth_HEADS == 1 && depth_BYTES == DEPTH_GRID_ROWS * DEPTH_GRID_COLS, "depth layout");
+  CHECK(DEPTH_GRID_ZERO == -128 && DEPTH_GRID_SCALE == 0.02f && DEPTH_GRID_RANGE == 5.0f,
+        "the expected values below assume 0.02 m per LSB from -128, clamped at 5 m");
+
+  uint8_t raw[depth_BYTES];
+  for (int i = 0; i < depth_BYTES; i++) raw[i] = (uint8_t)(i * 4 - 128);
+  // (q + 128) * 0.02: -128 -> 0 m, -78 -> 1 m, 72 -> 4 m, 122 -> 5 m, 127 -> 5.1 m clamped to 5 m
+  const struct { int8_t q; float m; } points[] = { { -128, 0.0f }, { -78, 1.0f }, { 72, 4.0f }, { 122, 5.0f }, { 127, 5.0f } };
+  for (uint32_t p = 0; p < sizeof(points) / sizeof(points[0]); p++) raw[p] = (uint8_t)points[p].q;
+
+  depth_output_t out;
+  depth_decode(raw, NULL, &out);
+  for (uint32_t p = 0; p < sizeof(points) / sizeof(points[0]); p++) {
+    CHECK_NEAR(out.depth[p], points[p].m, 1e-5f, "depth point");
+  }
+  for (int i = 5; i < depth_BYTES; i++) {
+    float m = (i * 4) * 0.02f;
+    CHECK_NEAR(out.depth[i], m > 5.0f ? 5.0f : m, 1e-5f, "depth grid");
+  }
+}
+
+// int16 heads, constant scale and zero point, sigmoid and tanh
+#define TEST_HEADS(HEAD) \
+  HEAD(gate, 0, 2, DECODE_INT16, 0.001f, -1000, DECODE_ACT_SIGMOID, -FLT_MAX, FLT_MAX) \
+  HEAD(turn, 4, 1, DECODE_INT16, 0.0005f, 0, DECODE_ACT_TANH, -0.5f, FLT_MAX)
+DECODER_DEFINE(test, TEST_HEADS)
+
+static void test_int16(void)
+{
+  CHECK(test_HEADS == 2 && test_BYTES == 6, "int16 layout");
+  // gate: (-1000 + 1000) * 0.001 = 0 -> 0.5; (1000 + 1000) * 0.001 = 2 -> 0.880797078
+  // turn: -2000 * 0.0005 = -1 -> tanh -0.761594156, clamped to -0.5
+  uint8_t raw[test_BYTES] = { 0x18, 0xFC, 0xE8, 0x03, 0x30, 0xF8 };
+  test_output_t out;
+  test_decode(raw, NULL, &out);
+  CHECK_NEAR(out.gate[0], 0.5f, TOL, "int16 sigmoid(0)");
+  CHECK_NEAR(out.gate[1], 0.880797078f, TOL, "int16 sigmoid(2)");
+  CHECK_NEAR(out.turn[0], -0.5f, 0.0f, "int16 tanh clamp");
+  raw[4] = 0xE8; raw[5] = 0x03;  // +1000 -> tanh(0.5) = 0.462117157
+  test_decode(raw, NULL, &out);
+  CHECK_NEAR(out.turn[0], 0.462117157f, TOL, "int16 tanh");
+}
+
+int main(void)
+{
+  test_dronet();
+  test_classifier();
+  test_depth();
+  test_int16();
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("decoder_test: all checks passed\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    filter_bank_test.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ The filters of inc/filter_bank.h against hand-computed outputs.
+
+ Short fixed sequences with known time steps check each filter's update
+ rule: the EMA weight at the nominal and at a doubled period, the median
+ window while filling and on outliers, the 1-euro low-pass and its
+ cutoff rising with speed, and the Kalman gain. Restarts on a long gap or
+ a change of type, and time steps across the 32-bit microsecond wrap, are
+ checked too. filter_bench measures cost and noise rejection; this test
+ only asserts. Exits non-zero on failure.
+
+   gcc -O2 -Wall -Wextra -Iinc host/filter_bank_test.c src/filter_bank.c -lm -o filter_bank_test
+   ./filter_bank_test
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "filter_bank.h"
+#include "check.h"
+
+#define NOMINAL_US  33333       // FILTER_NOMINAL_DT in us, as the frames arrive at 30 Hz
+#define TOL         1e-5f
+
+static void test_none(void)
+{
+  filter_config_t config = { .type = FILTER_NONE };
+  filter_state_t state;
+  filter_reset(&state);
+  const float xs[] = { 1.0f, -5.0f, 0.25f };
+  for (int i = 0; i < 3; i++) CHECK_NEAR(filter_update(&config, &state, xs[i], i * NOMINAL_US), xs[i], TOL, "none");
+}
+
+static void test_ema(void)
+{
+  // alpha 0.5: tau = FILTER_NOMINAL_DT, so the weight of a new sample is 1/2 at dt = tau and 2/3 at dt = 2 tau
+  filter_config_t config = { .type = FILTER_EMA, .alpha = 0.5f };
+  filter_state_t state;
+  filter_reset(&state);
+  uint32_t t = 1000;
+  CHECK_NEAR(filter_update(&config, &state, 4.0f, t), 4.0f, TOL, "ema first sample");
+  // NOMINAL_US is 1/30 s rounded down to the microsecond: the weights are a hair below 1/2 and 2/3
+  float dt = NOMINAL_US * 1e-6f, tau = FILTER_NOMINAL_DT;
+  float y = 4.0f - dt / (tau + dt) * 4.0f;
+  t += NOMINAL_US;
+  CHECK_NEAR(filter_update(&config, &state, 0.0f, t), y, TOL, "ema at the nominal period");
+  CHECK(fabsf(y - 2.0f) < 1e-4f, "ema weight at the nominal period must be 1/2");
+  y += 2.0f * dt / (tau + 2.0f * dt) * (5.0f - y);
+  t += 2 * NOMINAL_US;
+  CHECK_NEAR(filter_update(&config, &state, 5.0f, t), y, TOL, "ema at twice the period");
+  CHECK(fabsf(y - 4.0f) < 1e-4f, "ema weight at twice the period must be 2/3");
+
+  // alpha 1 (or out of range) passes samples through
+  config.alpha = 1.0f;
+  t += NOMINAL_US;
+  CHECK_NEAR(filter_update(&config, &state, -7.0f, t), -7.0f, TOL, "ema alpha 1");
+}
+
+static void test_median(void)
+{
+  filter_config_t config = { .type = FILTER_MEDIAN, .median_n = 5 };
+  filter_state_t state;
+  filter_reset(&state);
+  // window while filling: 1; 1,3 -> 2; 1,3,2 -> 2; 1,3,2,10 -> 2.5; then the outlier 10 never reaches the output
+  const float xs[]       = { 1.0f, 3.0f, 2.0f, 10.0f, 2.0f, 2.0f, -50.0f, 2.0f, 2.0f };
+  const float expected[] = { 1.0f, 2.0f, 2.0f, 2.5f,  2.0f, 2.0f, 2.0f,   2.0f, 2.0f };
+  for (int i = 0; i < 9; i++) {
+    float y = filter_update(&config, &state, xs[i], (uint32_t)i * NOMINAL_US);
+    CHECK(fabsf(y - expected[i]) <= TOL, "median sample %d: %g, expected %g", i, (double)y, (double)expected[i]);
+  }
+  // a shorter window restarts from the next sample
+  config.median_n = 3;
+  CHECK_NEAR(filter_update(&config, &state, 9.0f, 9 * NOMINAL_US), 9.0f, TOL, "median window shrunk");
+  CHECK_NEAR(filter_update(&config, &state, 1.0f, 10 * NOMINAL_US), 5.0f, TOL, "median after restart");
+
+  // shrunk while still filling: 4 samples in a window of 5, then a window of 4 must not write past it
+  config.median_n = 5;
+  filter_reset(&state);
+  for (int i = 0; i < 4; i++) filter_update(&config, &state, 1.0f, (uint32_t)i * NOMINAL_US);
+  config.median_n = 4;
+  CHECK_NEAR(filter_update(&config, &state, 100.0f, 4 * NOMINAL_US), 100.0f, TOL, "median window shrunk while filling");
+  CHECK_NEAR(filter_update(&config, &state, 100.0f, 5 * NOMINAL_US), 100.0f, TOL, "median after restart while filling");
+}
+
+static void test_one_euro(void)
+{
+  // beta 0: a first-order low-pass at min_cutoff, alpha = dt / (1 / (2 pi fc) + dt)
+  filter_config_t config = { .type = FILTER_ONE_EURO, .min_cutoff = 1.0f, .beta = 0.0f, .d_cutoff = 1.0f };
+  filter_state_t state;
+  filter_reset(&state);
+  float dt = NOMINAL_US * 1e-6f;
+  float alpha = dt / (1.0f / (2.0f * (float)M_PI) + dt);
+  filter_update(&config, &state, 0.0f, 0);
+  float y = filter_update(&config, &state, 1.0f, NOMINAL_US);
+  CHECK_NEAR(y, alpha, TOL, "one-euro step, beta 0");
+
+  // with beta > 0 the same step moves the output further: the cutoff rises with the speed
+  config.beta = 1.0f;
+  filter_state_t fast;
+  filter_reset(&fast);
+  filter_update(&config, &fast, 0.0f, 0);
+  float y_fast = filter_update(&config, &fast, 1.0f, NOMINAL_US);
+  float speed = alpha * (1.0f / dt);                     // filtered derivative after one step
+  float alpha_fast = dt / (1.0f / (2.0f * (float)M_PI * (1.0f + speed)) + dt);
+  CHECK_NEAR(y_fast, alpha_fast, TOL, "one-euro step, beta 1");
+  CHECK(y_fast > y, "one-euro: a faster signal must be followed more closely");
+
+  // a constant input stays exactly constant
+  filter_reset(&state);
+  for (int i = 0; i < 20; i++) y = filter_update(&config, &state, 0.3f, (uint32_t)i * NOMINAL_US);
+  CHECK_NEAR(y, 0.3f, TOL, "one-euro constant");
+}
+
+static void test_kalman(void)
+{
+  // p starts at r; each step p += q dt, k = p / (p + r), y += k (x - y), p *= 1 - k
+  filter_config_t config = { .type = FILTER_KALMAN, .q = 3.0f, .r = 0.1f };
+  filter_state_t state;
+  filter_reset(&state);
+  filter_update(&config, &state, 0.0f, 0);
+  float dt = 0.1f;
+  float p = 0.1f + 3.0f * dt;                           // 0.4
+  float k = p / (p + 0.1f);                             // 0.8
+  CHECK_NEAR(filter_update(&config, &state, 1.0f, 100000), k, TOL, "kalman first gain");
+  p = p * (1.0f - k) + 3.0f * dt;                       // 0.38
+  float k2 = p / (p + 0.1f);
+  CHECK_NEAR(filter_update(&config, &state, 1.0f, 200000), k + k2 * (1.0f - k), TOL, "kalman second gain");
+}
+
+static void test_restarts(void)
+{
+  filter_config_t config = { .type = FILTER_EMA, .alpha = 0.1f };
+  filter_state_t state;
+  filter_reset(&state);
+  filter_update(&config, &state, 0.0f, 0);
+  filter_update(&config, &state, 0.0f, NOMINAL_US);
+  // a gap longer than FILTER_MAX_GAP_US: the next sample goes straight through
+  CHECK_NEAR(filter_update(&config, &state, 8.0f, NOMINAL_US + FILTER_MAX_GAP_US + 1), 8.0f, TOL, "restart after a gap");
+  // a change of type restarts as well
+  config.type = FILTER_KALMAN;
+  config.q = 1.0f;
+  config.r = 1.0f;
+  CHECK_NEAR(filter_update(&config, &state, -2.0f, 2 * NOMINAL_US + FILTER_MAX_GAP_US), -2.0f, TOL, "restart on a new type");
+
+  // the microsecond counter wraps between two frames: a normal step, not a gap
+  config = (filter_config_t){ .type = FILTER_EMA, .alpha = 0.5f };
+  filter_reset(&state);
+  uint32_t t = 0xFFFFFFFFu - NOMINAL_US / 2;
+  filter_update(&config, &state, 0.0f, t);
+  CHECK_NEAR(filter_update(&config, &state, 2.0f, t + NOMINAL_US), 1.0f, TOL, "step across the wrap");
+}
+
+int main(void)
+{
+  test_none();
+  test_ema();
+  test_median();
+  test_one_euro();
+  test_kalman();
+  test_restarts();
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("filter_bank_test: all checks passed\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    filter_bench.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Cost and quality of the filters in inc/filter_bank.h on the host.
+
+ A synthetic steering signal (steps and a sine) with noise, 2% outliers and
+ frame intervals jittering around 33 ms is fed to every filter. Reported:
+ time and TSC cycles per update, and the RMS error against the clean signal.
+
+   gcc -O2 -Iinc host/filter_bench.c src/filter_bank.c -lm -o filter_bench
+   ./filter_bench
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TSC() __rdtsc()
+#else
+#define TSC() 0
+#endif
+
+#include "filter_bank.h"
+
+#define N_SAMPLES   200000
+
+static const char *names[FILTER_N_TYPES] = { "none", "ema", "median", "one-euro", "kalman" };
+
+static float noise(void)
+{
+  // sum of uniforms, roughly gaussian with unit variance
+  float sum = 0.0f;
+  for (int i = 0; i < 12; i++) sum += (float)rand() / RAND_MAX;
+  return sum - 6.0f;
+}
+
+int main(void)
+{
+  static float clean[N_SAMPLES], noisy[N_SAMPLES];
+  static uint32_t t_us[N_SAMPLES];
+  srand(1);
+  uint32_t t = 0;
+  for (int i = 0; i < N_SAMPLES; i++) {
+    t += 23000 + rand() % 20000;  // [us] 33 ms +/- 10 ms
+    float s = t * 1e-6f;
+    clean[i] = ((int)(s / 3.0f) % 2 ? 0.5f : -0.5f) + 0.3f * sinf(s);
+    noisy[i] = clean[i] + 0.08f * noise();
+    if (rand() % 50 == 0) noisy[i] += (rand() % 2 ? 1.0f : -1.0f);  // outlier
+    t_us[i] = t;
+  }
+
+  filter_config_t config = {
+    .alpha = 0.3f, .median_n = 5,
+    .min_cutoff = 1.0f, .beta = 0.5f, .d_cutoff = 1.0f,
+    .q = 0.5f, .r = 0.01f,
+  };
+  printf("%-9s %10s %12s %10s\n", "filter", "ns/update", "cycles/upd", "rms error");
+  for (int type = 0; type < FILTER_N_TYPES; type++) {
+    config.type = type;
+    filter_state_t state;
+    filter_reset(&state);
+    double err2 = 0.0;
+    volatile float out = 0.0f;
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint64_t c0 = TSC();
+    for (int i = 0; i < N_SAMPLES; i++) {
+      out = filter_update(&config, &state, noisy[i], t_us[i]);
+      (void)out;
+    }
+    uint64_t c1 = TSC();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    filter_reset(&state);
+    for (int i = 0; i < N_SAMPLES; i++) {
+      float e = filter_update(&config, &state, noisy[i], t_us[i]) - clean[i];
+      err2 += e * e;
+    }
+    double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / N_SAMPLES;
+    printf("%-9s %10.1f %12.1f %10.4f\n", names[type], ns, (double)(c1 - c0) / N_SAMPLES, sqrt(err2 / N_SAMPLES));
+  }
+  return 0;
+}
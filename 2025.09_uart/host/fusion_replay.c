@@ -0,0 +1,182 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    fusion_replay.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Replay of interleaved network streams through inc/fusion.h on the host.
+
+ Three sources at different rates and latencies feed a 100 Hz control tick:
+   0  DroNet   30 Hz, required, steering sweeping, drops out for 600 ms at t = 7 s
+   1  gate     10 Hz, 40 ms latency, steers towards +0.5
+   2  person    5 Hz, 120 ms latency, asks to stop between t = 4 s and 5 s
+ Every tick is checked against a brute-force recomputation of the rules in
+ fusion.h. A second run hammers one slot from a writer thread while the
+ main thread reads it, and checks no result is ever seen half-written.
+ Exits with 1 on any failed check.
+
+   gcc -O2 -Wall -Wextra -pthread -Iinc host/fusion_replay.c src/fusion.c -lm -o fusion_replay
+   ./fusion_replay
+*/
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fusion.h"
+
+#define TICK_US       10000
+#define DURATION_US   10000000
+
+typedef struct {
+  uint32_t period_us, latency_us, next_us;
+} stream_t;
+
+static int failures = 0;
+
+static void check(bool ok, uint32_t t, const char *what)
+{
+  if (!ok && failures++ < 10) printf("FAIL t=%.2f s: %s\n", t * 1e-6, what);
+}
+
+static fusion_command_t source_command(int source, uint32_t t_capture)
+{
+  float s = t_capture * 1e-6f;
+  fusion_command_t c = { 0.0f, 1.0f, 1.0f };
+  if (source == 0) {
+    c.steering = sinf(s);
+    c.speed = 0.8f;
+  } else if (source == 1) {
+    c.steering = 0.5f;
+    c.confidence = 0.7f;
+  } else if (source == 2 && s >= 4.0f && s < 5.0f) {
+    c.speed = 0.0f;
+    c.confidence = 0.9f;
+  }
+  return c;
+}
+
+static int replay(void)
+{
+  static fusion_t fusion;
+  fusion_init(&fusion);
+  for (int i = 0; i < 3; i++) {
+    fusion.config[i] = (fusion_source_config_t){ .enable = 1, .required = (i == 0),
+                                                 .weight = i == 0 ? 1.0f : 0.5f,
+                                                 .max_age_us = i == 0 ? 200000 : 500000 };
+  }
+  stream_t streams[3] = { { 33333, 0, 0 }, { 100000, 40000, 5000 }, { 200000, 120000, 17000 } };
+  uint32_t last_t[3] = { 0 };
+  bool has[3] = { false };
+  uint32_t valid_ticks = 0, stop_ticks = 0;
+
+  for (uint32_t now = TICK_US; now <= DURATION_US; now += TICK_US) {
+    // results arriving since the last tick, interleaved in arrival order
+    for (int i = 0; i < 3; i++) {
+      while (streams[i].next_us <= now) {
+        uint32_t arrival = streams[i].next_us;
+        streams[i].next_us += streams[i].period_us;
+        if (i == 0 && arrival >= 7000000 && arrival < 7600000) continue;  // DroNet outage
+        uint32_t t_capture = arrival - streams[i].latency_us;
+        fusion_command_t c = source_command(i, t_capture);
+        fusion_publish(&fusion, i, t_capture, &c);
+        last_t[i] = t_capture;
+        has[i] = true;
+      }
+    }
+    fusion_output_t out;
+    bool valid = fusion_tick(&fusion, now, &out);
+
+    // reference
+    float w_sum = 0.0f, steer = 0.0f, speed = 1.0f;
+    bool ref_valid = has[0] && now - last_t[0] <= fusion.config[0].max_age_us;
+    for (int i = 0; i < 3; i++) {
+      uint32_t age = now - last_t[i];
+      if (!has[i] || age > fusion.config[i].max_age_us) continue;
+      fusion_command_t c = source_command(i, last_t[i]);
+      float w = fusion.config[i].weight * c.confidence * (1.0f - (float)age / fusion.config[i].max_age_us);
+      steer += w * c.steering;
+      w_sum += w;
+      float limit = 1.0f - c.confidence * (1.0f - c.speed);
+      if (limit < speed) speed = limit;
+    }
+    check(valid == ref_valid, now, "validity");
+    if (valid && ref_valid) {
+      check(fabsf(out.command.steering - (w_sum > 0 ? steer / w_sum : 0.0f)) < 1e-5f, now, "steering");
+      check(fabsf(out.command.speed - speed) < 1e-6f, now, "speed");
+      check(out.command.steering >= -1.0f && out.command.steering <= 1.0f, now, "steering range");
+      valid_ticks++;
+      if (out.command.speed < 0.2f) stop_ticks++;
+    }
+  }
+  printf("replay: %lu ticks, %lu valid, %lu invalid, %lu slowed by the person detector\n",
+         (unsigned long)fusion.ticks, (unsigned long)valid_ticks, (unsigned long)fusion.invalid,
+         (unsigned long)stop_ticks);
+  for (int i = 0; i < 3; i++) {
+    printf("  source %d: published %lu, used %lu, rejected %lu\n", i, (unsigned long)fusion.published[i],
+           (unsigned long)fusion.used[i], (unsigned long)fusion.rejected[i]);
+  }
+  return 0;
+}
+
+// Writer thread: results whose fields all encode the same counter (full confidence: fused = published)
+static fusion_t stress;
+static volatile bool stress_done = false;
+
+static void *stress_writer(void *arg)
+{
+  (void)arg;
+  for (uint32_t k = 1; !stress_done; k++) {
+    float v = (float)(k & 0xFFFF) / 65536.0f;
+    fusion_command_t c = { v, v, 1.0f };
+    fusion_publish(&stress, 1, k, &c);
+  }
+  return NULL;
+}
+
+static void stress_test(void)
+{
+  fusion_init(&stress);
+  stress.config[1] = (fusion_source_config_t){ .enable = 1, .weight = 1.0f, .max_age_us = 0xFFFFFFFF };
+  pthread_t writer;
+  pthread_create(&writer, NULL, stress_writer, NULL);
+  uint32_t reads = 0;
+  for (int i = 0; i < 2000000; i++) {
+    fusion_output_t out;
+    if (!fusion_tick(&stress, 0, &out)) continue;
+    reads++;
+    // steering and speed come from the same result, and the result from the stamped counter
+    float v = (float)(out.t_newest_us & 0xFFFF) / 65536.0f;
+    check(out.command.steering == out.command.speed && out.command.speed == v, 0, "torn result");
+  }
+  stress_done = true;
+  pthread_join(writer, NULL);
+  printf("stress: %lu consistent reads of %lu writes, %lu skipped while rewritten\n", (unsigned long)reads,
+         (unsigned long)stress.published[1], (unsigned long)stress.torn);
+}
+
+int main(void)
+{
+  replay();
+  stress_test();
+  printf(failures ? "FAILED (%d)\n" : "ok\n", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    inference_queue_test.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Producer/consumer stress test of inc/inference_queue.h.
+
+ A producer thread plays the DMA interrupt and pushes records whose every
+ field is derived from a running counter; the main thread plays the UART
+ task and pops them. The consumer checks that records arrive in order,
+ are never duplicated or half-written, and that every record was either
+ popped or counted as an overflow. A single-threaded run first checks the
+ full and empty edges. Exits non-zero on failure.
+
+   gcc -O2 -Wall -Wextra -pthread -Iinc host/inference_queue_test.c src/inference_queue.c -o inference_queue_test
+   ./inference_queue_test [records]
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "inference_queue.h"
+#include "check.h"
+
+static inference_queue_t queue;
+static uint32_t n_records = 2000000;
+static volatile int producer_done = 0;
+
+static void record_make(inference_record_t *record, uint32_t i)
+{
+  record->timestamp = i;
+  record->t_irq = i * 3;
+  record->t_decode = i * 3 + 1;
+  record->seq = (uint8_t)i;
+  record->n_outputs = INFERENCE_MAX_OUTPUTS;
+  for (int k = 0; k < INFERENCE_MAX_OUTPUTS; k++) {
+    record->outputs[k] = (int32_t)(i ^ (0x5A5A5A5Au << k));
+    record->zero_point[k] = (int32_t)(i + k);
+    record->scale[k] = (float)(i & 0xFFFF);
+  }
+}
+
+// true if every field matches record_make() of the record's own timestamp
+static bool record_intact(const inference_record_t *record)
+{
+  inference_record_t expected;
+  record_make(&expected, record->timestamp);
+  bool ok = record->t_irq == expected.t_irq && record->t_decode == expected.t_decode &&
+            record->seq == expected.seq && record->n_outputs == expected.n_outputs;
+  for (int k = 0; k < INFERENCE_MAX_OUTPUTS; k++) {
+    ok = ok && record->outputs[k] == expected.outputs[k] && record->zero_point[k] == expected.zero_point[k] &&
+         record->scale[k] == expected.scale[k];
+  }
+  return ok;
+}
+
+static void test_edges(void)
+{
+  inference_record_t record;
+  inference_queue_init(&queue);
+  CHECK(!inference_queue_pop(&queue, &record), "empty queue must not pop");
+  for (uint32_t i = 0; i < INFERENCE_QUEUE_SIZE; i++) {
+    record_make(&record, i);
+    CHECK(inference_queue_push(&queue, &record), "push %u of %u must fit", (unsigned)i, INFERENCE_QUEUE_SIZE);
+  }
+  record_make(&record, INFERENCE_QUEUE_SIZE);
+  CHECK(!inference_queue_push(&queue, &record), "push into a full queue must fail");
+  CHECK(queue.overflows == 1 && queue.high_water == INFERENCE_QUEUE_SIZE, "overflows %u high water %u",
+        (unsigned)queue.overflows, (unsigned)queue.high_water);
+  CHECK(inference_queue_count(&queue) == INFERENCE_QUEUE_SIZE, "count of a full queue");
+  for (uint32_t i = 0; i < INFERENCE_QUEUE_SIZE; i++) {
+    CHECK(inference_queue_pop(&queue, &record) && record.timestamp == i && record_intact(&record),
+          "pop %u must return the oldest record", (unsigned)i);
+  }
+  CHECK(!inference_queue_pop(&queue, &record), "drained queue must not pop");
+}
+
+static void *producer(void *arg)
+{
+  (void)arg;
+  inference_record_t record;
+  for (uint32_t i = 0; i < n_records; i++) {
+    record_make(&record, i);
+    inference_queue_push(&queue, &record);
+    // bursts longer than the ring: it overflows unless the consumer runs in between (also paces a single-core host)
+    if (i % (INFERENCE_QUEUE_SIZE + 4) == 0) sched_yield();
+  }
+  __atomic_store_n(&producer_done, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static void test_stress(void)
+{
+  inference_queue_init(&queue);
+  pthread_t thread;
+  pthread_create(&thread, NULL, producer, NULL);
+
+  inference_record_t record;
+  uint32_t popped = 0, skipped = 0, torn = 0, out_of_order = 0;
+  int64_t last = -1;
+  for (;;) {
+    int done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+    if (!inference_queue_pop(&queue, &record)) {
+      if (done) break;
+      sched_yield();
+      continue;
+    }
+    popped++;
+    if (!record_intact(&record)) torn++;
+    if ((int64_t)record.timestamp <= last) out_of_order++;
+    else skipped += record.timestamp - (uint32_t)(last + 1);
+    last = record.timestamp;
+  }
+  pthread_join(thread, NULL);
+  skipped += n_records - (uint32_t)(last + 1);  // dropped after the last record popped
+
+  printf("stress: %u records, %u popped, %u overflows, high water %u\n", (unsigned)n_records, (unsigned)popped,
+         (unsigned)queue.overflows, (unsigned)queue.high_water);
+  CHECK(torn == 0, "%u half-written records", (unsigned)torn);
+  CHECK(out_of_order == 0, "%u records out of order or duplicated", (unsigned)out_of_order);
+  CHECK(queue.pushed == popped, "pushed %u, popped %u", (unsigned)queue.pushed, (unsigned)popped);
+  CHECK(queue.pushed + queue.overflows == n_records, "pushed %u + overflows %u != %u",
+        (unsigned)queue.pushed, (unsigned)queue.overflows, (unsigned)n_records);
+  CHECK(skipped == queue.overflows, "%u records missing, %u overflows counted", (unsigned)skipped, (unsigned)queue.overflows);
+  CHECK(queue.high_water <= INFERENCE_QUEUE_SIZE, "high water %u", (unsigned)queue.high_water);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1) n_records = (uint32_t)strtoul(argv[1], NULL, 0);
+  test_edges();
+  test_stress();
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("inference_queue_test: all checks passed\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    link_health_test.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Stall test of the link watchdog (inc/link_health.h) with the thresholds of
+ inc/config_main.h.
+
+ Frames arrive at 100 Hz while the watchdog is stepped every 10 ms like
+ flight_loop() does, then the stream stalls. Checks that SLOW, HOVER and
+ LAND are entered at the configured ages, that SLOW and HOVER clear when
+ frames resume, that LAND stays latched until re-armed, and that a frame
+ stamped after the consumer sampled its clock reads as age 0 (also across
+ the 32-bit wrap of the microsecond counter), while a silence of more than
+ 2^31 us before arming still trips it. Exits non-zero on failure.
+
+   gcc -O2 -Wall -Wextra -Iinc host/link_health_test.c src/link_health.c -o link_health_test
+   ./link_health_test
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_main.h"
+#include "link_health.h"
+#include "check.h"
+
+#define FRAME_US    10000   // [us] 100 Hz inference stream
+#define TICK_MS     10      // [ms] flight loop period
+
+typedef struct {
+  link_health_t health;
+  link_watchdog_t wd;
+  uint32_t now_us;
+  uint32_t entered_ms[LINK_N_LEVELS]; // [ms] first tick at each level, relative to the start of the stall
+} sim_t;
+
+static void sim_init(sim_t *sim, uint32_t start_us)
+{
+  link_watchdog_config_t config = { .slow_ms = WATCHDOG_SLOW_MS, .hover_ms = WATCHDOG_HOVER_MS, .land_ms = WATCHDOG_LAND_MS };
+  sim->now_us = start_us;
+  link_health_init(&sim->health, sim->now_us);
+  link_watchdog_init(&sim->wd, &config);
+  link_watchdog_arm(&sim->wd, sim->now_us / 1000);
+}
+
+static link_level_t sim_tick(sim_t *sim)
+{
+  uint32_t age_ms = link_health_age_us(&sim->health, sim->now_us) / 1000;
+  return link_watchdog_step(&sim->wd, sim->now_us / 1000, age_ms);
+}
+
+// run duration_ms of flight loop ticks, with or without frames; returns the last level
+static link_level_t sim_run(sim_t *sim, uint32_t duration_ms, int frames, uint32_t stall_start_us)
+{
+  link_level_t level = (link_level_t)sim->wd.level;
+  for (uint32_t t = 0; t < duration_ms; t += TICK_MS) {
+    for (uint32_t k = 0; k < TICK_MS * 1000 / FRAME_US; k++) {
+      sim->now_us += FRAME_US;
+      if (frames) link_health_frame(&sim->health, sim->now_us);
+    }
+    link_level_t previous = level;
+    level = sim_tick(sim);
+    if (level != previous && sim->entered_ms[level] == 0) {
+      sim->entered_ms[level] = (sim->now_us - stall_start_us) / 1000;
+    }
+  }
+  return level;
+}
+
+static void test_stall(uint32_t start_us)
+{
+  sim_t sim = {0};
+  sim_init(&sim, start_us);
+  CHECK(sim_run(&sim, 2000, 1, 0) == LINK_OK, "healthy stream must stay OK");
+  CHECK(sim.wd.trips[LINK_SLOW] == 0, "no trip on a healthy stream");
+
+  uint32_t stall_us = sim.now_us;
+  link_level_t level = sim_run(&sim, WATCHDOG_LAND_MS + 500, 0, stall_us);
+  CHECK(level == LINK_LAND, "stall must end in LAND, got %d", level);
+  // the level is graded once per tick, so each entry is at most one tick late
+  for (int l = LINK_SLOW; l <= LINK_LAND; l++) {
+    uint32_t expected = l == LINK_SLOW ? WATCHDOG_SLOW_MS : l == LINK_HOVER ? WATCHDOG_HOVER_MS : WATCHDOG_LAND_MS;
+    CHECK(sim.entered_ms[l] >= expected && sim.entered_ms[l] < expected + TICK_MS,
+          "level %d entered after %u ms, expected %u ms", l, (unsigned)sim.entered_ms[l], (unsigned)expected);
+    CHECK(sim.wd.trips[l] == 1, "level %d entered %u times", l, (unsigned)sim.wd.trips[l]);
+  }
+  printf("start %10u us: SLOW %4u ms  HOVER %4u ms  LAND %4u ms\n", (unsigned)start_us,
+         (unsigned)sim.entered_ms[LINK_SLOW], (unsigned)sim.entered_ms[LINK_HOVER], (unsigned)sim.entered_ms[LINK_LAND]);
+
+  // LAND is latched even when frames come back
+  CHECK(sim_run(&sim, 500, 1, stall_us) == LINK_LAND, "LAND must stay latched");
+  link_watchdog_arm(&sim.wd, sim.now_us / 1000);
+  CHECK(sim_tick(&sim) == LINK_OK, "re-arming must clear LAND");
+}
+
+static void test_recovery(void)
+{
+  sim_t sim = {0};
+  sim_init(&sim, 0);
+  sim_run(&sim, 500, 1, 0);
+  CHECK(sim_run(&sim, WATCHDOG_HOVER_MS + 100, 0, 0) == LINK_HOVER, "stall past hover_ms must HOVER");
+  CHECK(sim_run(&sim, 100, 1, 0) == LINK_OK, "HOVER must clear when frames resume");
+  CHECK(sim_run(&sim, WATCHDOG_SLOW_MS + 50, 0, 0) == LINK_SLOW, "short stall must SLOW");
+  CHECK(sim_run(&sim, 100, 1, 0) == LINK_OK, "SLOW must clear when frames resume");
+}
+
+static void test_silent_before_arming(void)
+{
+  // no frame for a long time before takeoff: the age only counts from the arming time
+  sim_t sim = {0};
+  sim_init(&sim, 0);
+  sim.now_us += 20000000;
+  link_watchdog_arm(&sim.wd, sim.now_us / 1000);
+  CHECK(sim_tick(&sim) == LINK_OK, "silence before arming must not trip the watchdog");
+  CHECK(sim_run(&sim, WATCHDOG_SLOW_MS + TICK_MS, 0, 0) == LINK_SLOW, "silence after arming must SLOW");
+}
+
+static void test_silent_half_wrap(void)
+{
+  // powered up 36 minutes before takeoff with no frame at all: more than 2^31 us, the age must not look negative
+  sim_t sim = {0};
+  sim_init(&sim, 0);
+  sim.now_us += 36u * 60u * 1000000u;
+  uint32_t age_us = link_health_age_us(&sim.health, sim.now_us);
+  CHECK(age_us == 36u * 60u * 1000000u, "36 min of silence must be 36 min old, got %u us", (unsigned)age_us);
+  link_watchdog_arm(&sim.wd, sim.now_us / 1000);
+  CHECK(sim_run(&sim, WATCHDOG_SLOW_MS + TICK_MS, 0, 0) == LINK_SLOW, "silence after arming must SLOW");
+  CHECK(sim_run(&sim, WATCHDOG_LAND_MS, 0, 0) == LINK_LAND, "silence after arming must LAND");
+}
+
+static void test_frame_newer_than_now(uint32_t start_us)
+{
+  // the consumer samples its clock, then the DMA interrupt stamps a frame before last_us is loaded
+  sim_t sim = {0};
+  sim_init(&sim, start_us);
+  sim_run(&sim, 1000, 1, 0);
+  uint32_t sampled_us = sim.now_us;
+  link_health_frame(&sim.health, sampled_us + 37);
+  uint32_t age_us = link_health_age_us(&sim.health, sampled_us);
+  CHECK(age_us == 0, "frame newer than now must be 0 old, got %u us", (unsigned)age_us);
+  CHECK(link_watchdog_step(&sim.wd, sampled_us / 1000, age_us / 1000) == LINK_OK, "race must not trip the watchdog");
+  CHECK(sim.wd.trips[LINK_LAND] == 0, "race must not LAND");
+}
+
+int main(void)
+{
+  test_stall(0);
+  test_stall(0xFFFFFFFFu - 3000000u);  // the microsecond counter wraps during the stall
+  test_recovery();
+  test_silent_before_arming();
+  test_silent_half_wrap();
+  test_frame_newer_than_now(1000000);
+  test_frame_newer_than_now(0xFFFFFFFFu - 1000000u - 20);  // the frame stamp wraps past now
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("link_health_test: all checks passed\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    link_rx.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Host build of the Crazyflie receive path, for testing the link without a drone.
+
+ Opens a pseudo-terminal and prints its path; link_tester.py connects to it
+ like to the AI-deck UART. Bytes go through the same frame parser, channel
+ dispatch and inference queue as the firmware. Timing probes are echoed, and
+ UART_MSG_LINK_STATS is sent once per second like on the Crazyflie.
+ The link watchdog runs as if the drone were flying and prints its level
+ changes, so stalls (link_tester.py --delay) can be checked without a drone.
+
+   gcc -O2 -Wall -Wextra -Iinc host/link_rx.c src/uart_frame.c src/uart_channel.c src/inference_queue.c src/tensor_rx.c \
+       src/link_health.c -o link_rx
+   ./link_rx
+*/
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "uart_frame.h"
+#include "uart_channel.h"
+#include "inference_queue.h"
+#include "tensor_rx.h"
+#include "link_health.h"
+
+static int pty_fd;
+static uint8_t tx_seq;
+static uint32_t rx_timestamp;       // [us] time the current bytes were read
+static uart_frame_parser_t parser;
+static inference_queue_t queue;
+static uint32_t latency_max;        // [us] read -> processed
+
+// 8x8 int8 grid, like the depth tensor of the firmware
+static const tensor_schema_t tensor_schema = { .id = 0, .elem_size = 1, .rows = 8, .cols = 8 };
+static uint8_t tensor_arena[TENSOR_ARENA_SIZE(8, 8, 1)];
+static tensor_rx_t tensor;
+
+static link_health_t health;
+static link_watchdog_t watchdog;
+static const char *level_names[LINK_N_LEVELS] = { "ok", "slow", "hover", "land" };
+
+static uint32_t now_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+static void send_frame(uint8_t msg_id, const void *payload, uint8_t len)
+{
+  uint8_t frame[UART_FRAME_MAX_SIZE];
+  uint32_t n = uart_frame_encode(frame, sizeof(frame), msg_id, tx_seq++, (const uint8_t *)payload, len);
+  if (write(pty_fd, frame, n) != (ssize_t)n) {
+    perror("write");
+  }
+}
+
+static void on_inference_frame(const uart_frame_t *frame, void *ctx)
+{
+  (void)ctx;
+  inference_record_t record;
+  memset(&record, 0, sizeof(record));
+  record.timestamp = rx_timestamp;
+  record.seq = frame->seq;
+  record.n_outputs = uart_frame_unpack_outputs(frame, record.outputs, INFERENCE_MAX_OUTPUTS);
+  link_health_frame(&health, rx_timestamp);
+  inference_queue_push(&queue, &record);
+}
+
+static void on_tensor_frame(const uart_frame_t *frame, void *ctx)
+{
+  (void)ctx;
+  uart_tensor_chunk_t chunk;
+  memcpy(&chunk, frame->payload, sizeof(chunk));
+  if (chunk.tensor_id == tensor_schema.id) {
+    tensor_rx_chunk(&tensor, chunk.frame, chunk.offset, &frame->payload[sizeof(chunk)], frame->len - sizeof(chunk));
+  }
+}
+
+static void on_timing_probe_frame(const uart_frame_t *frame, void *ctx)
+{
+  (void)ctx;
+  uart_timing_msg_t probe;
+  memcpy(&probe, frame->payload, sizeof(probe));
+  probe.t_rx = rx_timestamp;
+  probe.t_tx = now_us();
+  send_frame(UART_MSG_TIMING_PROBE, &probe, sizeof(probe));
+}
+
+static void on_ignored_frame(const uart_frame_t *frame, void *ctx)
+{
+  (void)frame;
+  (void)ctx;
+}
+
+enum { CH_INFERENCE = 0, CH_INFERENCE_Q8, CH_INFERENCE_Q16, CH_QUANT, CH_QUANT_TABLE, CH_NET_COMMAND, CH_TENSOR, CH_DEBUG_TEXT, CH_CONFIG_ACK, CH_TIMING, N_CHANNELS };
+static const uart_channel_t channels[N_CHANNELS] = {
+  [CH_INFERENCE]  = { UART_MSG_INFERENCE,    1, 4 * INFERENCE_MAX_OUTPUTS, on_inference_frame },
+  [CH_INFERENCE_Q8]  = { UART_MSG_INFERENCE_Q8,  1, INFERENCE_MAX_OUTPUTS, on_inference_frame },
+  [CH_INFERENCE_Q16] = { UART_MSG_INFERENCE_Q16, 1, 2 * INFERENCE_MAX_OUTPUTS, on_inference_frame },
+  [CH_QUANT]      = { UART_MSG_QUANT_HEADER, sizeof(uart_quant_msg_t), sizeof(uart_quant_msg_t), on_ignored_frame },
+  [CH_QUANT_TABLE] = { UART_MSG_QUANT_TABLE, sizeof(uart_quant_table_msg_t) + sizeof(uart_quant_msg_t), UART_FRAME_MAX_PAYLOAD, on_ignored_frame },
+  [CH_NET_COMMAND] = { UART_MSG_NET_COMMAND, sizeof(uart_net_command_msg_t), sizeof(uart_net_command_msg_t), on_ignored_frame },
+  [CH_TENSOR]     = { UART_MSG_TENSOR, sizeof(uart_tensor_chunk_t) + 1, UART_FRAME_MAX_PAYLOAD, on_tensor_frame },
+  [CH_DEBUG_TEXT] = { UART_MSG_DEBUG_TEXT,   1, UART_FRAME_MAX_PAYLOAD, on_ignored_frame },
+  [CH_CONFIG_ACK] = { UART_MSG_CONFIG_ACK,   2, 2, on_ignored_frame },
+  [CH_TIMING]     = { UART_MSG_TIMING_PROBE, sizeof(uart_timing_msg_t), sizeof(uart_timing_msg_t), on_timing_probe_frame },
+};
+static uart_channel_stats_t channel_stats[N_CHANNELS];
+
+int main(void)
+{
+  pty_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (pty_fd < 0 || grantpt(pty_fd) != 0 || unlockpt(pty_fd) != 0) {
+    perror("pty");
+    return 1;
+  }
+  // raw mode on the device side, so the tester's bytes are not translated
+  int slave = open(ptsname(pty_fd), O_RDWR | O_NOCTTY);
+  struct termios tio;
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+  printf("%s\n", ptsname(pty_fd));
+  fflush(stdout);
+
+  uart_dispatch_t dispatch;
+  uart_frame_parser_init(&parser);
+  uart_dispatch_init(&dispatch, channels, channel_stats, N_CHANNELS, NULL);
+  inference_queue_init(&queue);
+  tensor_rx_init(&tensor, &tensor_schema, tensor_arena, NULL, NULL);
+  link_health_init(&health, now_us());
+  link_watchdog_config_t watchdog_config = { .slow_ms = 300, .hover_ms = 1000, .land_ms = 5000 };
+  link_watchdog_init(&watchdog, &watchdog_config);
+  link_watchdog_arm(&watchdog, now_us() / 1000);
+
+  uint32_t t_stats = now_us();
+  uint8_t buf[256];
+  while (1) {
+    struct pollfd pfd = { .fd = pty_fd, .events = POLLIN };
+    if (poll(&pfd, 1, 10) > 0) {
+      ssize_t n = read(pty_fd, buf, sizeof(buf));
+      if (n <= 0) continue;
+      rx_timestamp = now_us();
+      uart_frame_parse(&parser, buf, (uint32_t)n, uart_channel_dispatch, &dispatch);
+    }
+
+    inference_record_t record;
+    while (inference_queue_pop(&queue, &record)) {
+      uint32_t latency = now_us() - record.timestamp;
+      if (latency > latency_max) latency_max = latency;
+    }
+
+    uint8_t level = watchdog.level;
+    link_watchdog_step(&watchdog, now_us() / 1000, link_health_age_us(&health, now_us()) / 1000);
+    if (watchdog.level != level) {
+      fprintf(stderr, "watchdog: %s -> %s\n", level_names[level], level_names[watchdog.level]);
+      if (watchdog.level == LINK_LAND) {
+        link_watchdog_arm(&watchdog, now_us() / 1000);  // the drone would be on the ground, start over
+      }
+    }
+    link_health_window(&health, now_us(), 1000000, parser.stats.crc_errors + queue.overflows);
+
+    if (now_us() - t_stats >= 1000000) {
+      t_stats = now_us();
+      uart_link_stats_msg_t msg = {
+        .frames = parser.stats.frames,
+        .crc_errors = parser.stats.crc_errors,
+        .resyncs = parser.stats.resyncs,
+        .bytes_dropped = parser.stats.bytes_dropped,
+        .seq_gaps = parser.stats.seq_gaps,
+        .queue_overflows = queue.overflows,
+        .latency_max = latency_max,
+      };
+      send_frame(UART_MSG_LINK_STATS, &msg, sizeof(msg));
+      if (health.frames) {
+        fprintf(stderr, "rate %.1f Hz errors %.1f Hz period %.0f us jitter %.0f us gap max %u us\n",
+                health.rate_hz, health.error_rate_hz, health.period_us, health.jitter_us, health.gap_max_us);
+      }
+      if (tensor.stats.chunks) {
+        fprintf(stderr, "tensors %u rows %u dropped %u overruns %u\n", tensor.stats.tensors, tensor.stats.rows,
+                tensor.stats.dropped, tensor.stats.overruns);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,187 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    path_bench.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Cost and tracking error of the paths in inc/path.h on the host.
+
+ Per-sample cost: path_sample() against the libm cos/sin of the old
+ flyCircle, in time and TSC cycles per sample, plus the build time and the
+ spread of the table spacing (constant speed) of every shape.
+ Tracking: the closed-loop horizontal dynamics are modelled per axis as a
+ second-order system (natural frequency WN, damping ZETA) with setpoints
+ held between updates. The old flyCircle (100 ms steps) and a circle of the
+ same radius and speed from path.h at SETPOINT_RATE are flown from rest;
+ reported is the distance of the drone from the intended circle.
+
+   gcc -O2 -Iinc host/path_bench.c src/path.c -lm -o path_bench
+   ./path_bench
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TSC() __rdtsc()
+#else
+#define TSC() 0
+#endif
+
+#include "config_main.h"
+#include "path.h"
+
+#define N_SAMPLES   1000000
+#define WN          3.0f    // [rad/s] position loop natural frequency
+#define ZETA        0.8f
+#define SIM_DT_MS   1
+#define RADIUS      0.5f    // [m] the call in the old flight loop
+#define SPEED       0.5f    // [m/s]
+
+static const char *names[PATH_N_TYPES] = { "circle", "figure-8", "lemniscate", "polygon", "spline" };
+
+static double now_ns(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+typedef struct {
+  float x, y, vx, vy;
+  uint32_t t_ms;
+  float cx, cy, r;        // intended circle
+  double err2, err_max;
+  uint32_t n;
+} plant_t;
+
+static void plant_step(plant_t *p, float x_sp, float y_sp)
+{
+  float dt = SIM_DT_MS * 1e-3f;
+  float ax = WN * WN * (x_sp - p->x) - 2.0f * ZETA * WN * p->vx;
+  float ay = WN * WN * (y_sp - p->y) - 2.0f * ZETA * WN * p->vy;
+  p->vx += ax * dt;
+  p->vy += ay * dt;
+  p->x += p->vx * dt;
+  p->y += p->vy * dt;
+  p->t_ms += SIM_DT_MS;
+  double e = fabs(hypot(p->x - p->cx, p->y - p->cy) - p->r);
+  p->err2 += e * e;
+  p->n++;
+  if (e > p->err_max) p->err_max = e;
+}
+
+static void plant_hold(plant_t *p, float x_sp, float y_sp, uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; t += SIM_DT_MS) plant_step(p, x_sp, y_sp);
+}
+
+static void report(const char *name, const plant_t *p)
+{
+  printf("%-22s %6.2f s   radial error rms %.3f m  max %.3f m   end (%.3f, %.3f)\n",
+         name, p->t_ms * 1e-3f, sqrt(p->err2 / p->n), p->err_max, p->x, p->y);
+}
+
+int main(void)
+{
+  path_config_t config = {
+    .size = RADIUS, .sides = PATH_SIDES, .closed = PATH_WAYPOINTS_CLOSED,
+    .waypoints = PATH_WAYPOINTS,
+  };
+  const float waypoints[][2] = PATH_WAYPOINTS;
+  config.n_waypoints = sizeof(waypoints) / sizeof(waypoints[0]);
+  static path_t path;
+
+  printf("%-10s %9s %9s %10s %12s %10s\n", "path", "length m", "build us", "ns/sample", "cycles/smp", "spacing");
+  for (int type = 0; type < PATH_N_TYPES; type++) {
+    config.type = type;
+    double t0 = now_ns();
+    if (!path_init(&path, &config)) {
+      printf("%-10s invalid\n", names[type]);
+      continue;
+    }
+    double build_us = (now_ns() - t0) * 1e-3;
+
+    volatile float sink = 0.0f;
+    float x, y;
+    float ds = 0.01f;  // 1 m/s at 100 Hz
+    t0 = now_ns();
+    uint64_t c0 = TSC();
+    for (int i = 0; i < N_SAMPLES; i++) {
+      path_sample(&path, i * ds, &x, &y, NULL, NULL);
+      sink += x + y;
+    }
+    uint64_t c1 = TSC();
+    double ns = (now_ns() - t0) / N_SAMPLES;
+
+    // distance between consecutive table points over the nominal step: 1 means constant speed
+    float lo = 1e9f, hi = 0.0f;
+    for (int k = 0; k < PATH_TABLE_SIZE; k++) {
+      float d = hypotf(path.table[k + 1][0] - path.table[k][0], path.table[k + 1][1] - path.table[k][1]);
+      if (d < lo) lo = d;
+      if (d > hi) hi = d;
+    }
+    printf("%-10s %9.3f %9.1f %10.1f %12.1f %4.2f..%4.2f\n", names[type], path.length, build_us, ns,
+           (double)(c1 - c0) / N_SAMPLES, lo * path.inv_step, hi * path.inv_step);
+  }
+
+  // the old per-step cost: two libm calls in double
+  {
+    volatile float sink = 0.0f;
+    double t0 = now_ns();
+    uint64_t c0 = TSC();
+    for (int i = 0; i < N_SAMPLES; i++) {
+      float a = M_PI + i * 2 * M_PI / 63 + 4;
+      sink += (float)cos(a) * RADIUS + (float)sin(a) * RADIUS;
+    }
+    uint64_t c1 = TSC();
+    printf("%-10s %9s %9s %10.1f %12.1f\n", "cos/sin", "", "", (now_ns() - t0) / N_SAMPLES,
+           (double)(c1 - c0) / N_SAMPLES);
+  }
+
+  // old flyCircle: center (r, 0) from the start, 100 ms per step, starts off the circle
+  printf("\ncircle r = %.2f m at %.2f m/s, WN %.1f rad/s\n", RADIUS, SPEED, WN);
+  plant_t old = { .cx = RADIUS, .r = RADIUS };
+  float distance = 2.0f * M_PI * RADIUS;
+  uint16_t steps = distance / SPEED * 1000 / 100;
+  for (int i = 0; i < steps; i++) {
+    float a = M_PI + i * 2 * M_PI / steps + 4;
+    plant_hold(&old, (float)cos(a) * RADIUS + RADIUS, (float)sin(a) * RADIUS, 100);
+  }
+  report("flyCircle, 100 ms steps", &old);
+
+  // new: path.h circle (center (-r, 0)) sampled at the setpoint rate, then the end point
+  config.type = PATH_CIRCLE;
+  path_init(&path, &config);
+  plant_t mj = { .cx = -RADIUS, .r = RADIUS };
+  uint32_t period_ms = 1000 / SETPOINT_RATE;
+  float x, y;
+  while (SPEED * mj.t_ms * 1e-3f < path.length) {
+    path_sample(&path, SPEED * mj.t_ms * 1e-3f, &x, &y, NULL, NULL);
+    plant_hold(&mj, x, y, period_ms);
+  }
+  path_sample(&path, path.length, &x, &y, NULL, NULL);
+  plant_hold(&mj, x, y, 1000);
+  report("path.h, setpoint rate", &mj);
+  return 0;
+}
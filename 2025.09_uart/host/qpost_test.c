@@ -0,0 +1,233 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    qpost_test.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Edge and random values through the kernels of inc/qpost.h.
+
+ Every kernel is checked against an independent model written with 64-bit
+ integers and floor division: dequantization over every int8 input with
+ the extreme zero points and scales, scaling into saturation, clamping,
+ argmax ties and pooling with leftover rows and columns. The multiplier
+ and shift of qpost_scale_from_float() are checked against the real scale.
+ On the host the public kernels are the reference; qpost_selftest() runs
+ too and compares both paths on the target. Exits non-zero on failure.
+
+   gcc -O2 -Wall -Wextra -Iinc host/qpost_test.c src/qpost.c -lm -o qpost_test
+   ./qpost_test [seed]
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qpost.h"
+#include "check.h"
+
+#define RANDOM_ROUNDS   2000
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 17;
+  seed ^= seed << 5;
+  return seed;
+}
+
+static int64_t model_sat16(int64_t x)
+{
+  return x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x);
+}
+
+// floor(x / 2^shift), independent of how >> treats negative numbers
+static int64_t model_shift(int64_t x, uint8_t shift)
+{
+  int64_t d = (int64_t)1 << shift;
+  return x >= 0 ? x / d : -((-x + d - 1) / d);
+}
+
+static int16_t model_dequant(int8_t q, int16_t zero_point, qpost_scale_t scale)
+{
+  return (int16_t)model_sat16(model_shift(model_sat16((int64_t)q - zero_point) * scale.mult, scale.shift));
+}
+
+static int16_t model_scale(int16_t x, qpost_scale_t scale)
+{
+  return (int16_t)model_sat16(model_shift((int64_t)x * scale.mult, scale.shift));
+}
+
+static qpost_scale_t random_scale(void)
+{
+  qpost_scale_t scale = { (int16_t)rnd(), (uint8_t)(rnd() % 32) };
+  return scale;
+}
+
+static void test_scale_from_float(void)
+{
+  // the integer pair reproduces scale * 2^frac_bits within the int16 multiplier's resolution
+  const float scales[] = { 1e-6f, 0.0006f, 0.00390625f, 0.1f, 0.5f, 1.0f, 3.7f, 100.0f, -0.25f, -7.3f };
+  for (uint32_t i = 0; i < sizeof(scales) / sizeof(scales[0]); i++) {
+    for (uint8_t frac = 0; frac <= 15; frac += 3) {
+      qpost_scale_t s = qpost_scale_from_float(scales[i], frac);
+      double target = ldexp(scales[i], frac);
+      double got = ldexp(s.mult, -(int)s.shift);
+      if (fabs(target) < ldexp(1.0, 15)) {
+        CHECK(fabs(got - target) <= fabs(target) * ldexp(1.0, -14) + ldexp(1.0, -(int)s.shift - 1),
+              "scale %g frac %u: %d >> %u = %g", scales[i], frac, s.mult, s.shift, got);
+        CHECK(abs(s.mult) >= 1 << 14 || s.shift == 31, "scale %g frac %u: mult %d not normalized", scales[i], frac, s.mult);
+      } else {
+        CHECK(s.shift == 0 && abs(s.mult) == INT16_MAX, "scale %g frac %u: must saturate", scales[i], frac);
+      }
+    }
+  }
+  qpost_scale_t zero = qpost_scale_from_float(0.0f, QPOST_FRAC_BITS);
+  CHECK(zero.mult == 0 && zero.shift == 0, "zero scale");
+}
+
+static void test_dequant(void)
+{
+  int8_t in[256];
+  int16_t out[256];
+  for (int i = 0; i < 256; i++) in[i] = (int8_t)(i - 128);
+
+  // every input with the extreme zero points, where in - zero_point leaves int16
+  const int16_t zero_points[] = { 0, -3, 127, -128, 32640, -32640, 32641, -32641, INT16_MAX, INT16_MIN };
+  const qpost_scale_t scales[] = { { 1, 0 }, { INT16_MAX, 15 }, { INT16_MAX, 0 }, { INT16_MIN, 0 }, { -1, 0 }, { 20133, 14 }, { 1, 31 } };
+  for (uint32_t z = 0; z < sizeof(zero_points) / sizeof(zero_points[0]); z++) {
+    for (uint32_t s = 0; s < sizeof(scales) / sizeof(scales[0]); s++) {
+      for (uint32_t n = 0; n <= 256; n += 255) {  // 0, and an odd count for the scalar tail
+        qpost_dequant_s8(in, out, n, zero_points[z], scales[s]);
+        for (uint32_t i = 0; i < n; i++) {
+          int16_t expected = model_dequant(in[i], zero_points[z], scales[s]);
+          CHECK(out[i] == expected, "dequant q %d zp %d mult %d shift %u: %d, expected %d",
+                in[i], zero_points[z], scales[s].mult, scales[s].shift, out[i], expected);
+        }
+      }
+    }
+  }
+  // saturation of the difference, not wrap-around: 127 - (-32768) is 32767, not -32641
+  int8_t q = 127;
+  int16_t y;
+  qpost_dequant_s8(&q, &y, 1, INT16_MIN, (qpost_scale_t){ 1, 0 });
+  CHECK(y == INT16_MAX, "127 - INT16_MIN must saturate, got %d", y);
+
+  for (uint32_t round = 0; round < RANDOM_ROUNDS; round++) {
+    uint32_t n = rnd() % 64;
+    int16_t zero_point = (int16_t)rnd();
+    qpost_scale_t scale = random_scale();
+    for (uint32_t i = 0; i < n; i++) in[i] = (int8_t)rnd();
+    qpost_dequant_s8(in, out, n, zero_point, scale);
+    for (uint32_t i = 0; i < n; i++) {
+      CHECK(out[i] == model_dequant(in[i], zero_point, scale), "random dequant round %u", (unsigned)round);
+    }
+  }
+}
+
+static void test_scale_clamp(void)
+{
+  int16_t data[65], copy[65];
+  const int16_t edges[] = { 0, 1, -1, 2, -2, INT16_MAX, INT16_MIN, INT16_MAX - 1, INT16_MIN + 1, 0x4000, -0x4000 };
+  uint32_t n_edges = sizeof(edges) / sizeof(edges[0]);
+  for (uint32_t round = 0; round < RANDOM_ROUNDS; round++) {
+    uint32_t n = rnd() % 66;
+    for (uint32_t i = 0; i < n; i++) copy[i] = data[i] = round < 20 ? edges[(i + round) % n_edges] : (int16_t)rnd();
+
+    qpost_scale_t scale = random_scale();
+    qpost_scale_s16(data, n, scale);
+    for (uint32_t i = 0; i < n; i++) {
+      CHECK(data[i] == model_scale(copy[i], scale), "scale %d * %d >> %u: %d", copy[i], scale.mult, scale.shift, data[i]);
+      copy[i] = data[i];
+    }
+
+    int16_t lo = (int16_t)rnd(), hi = (int16_t)rnd();
+    if (lo > hi) { int16_t t = lo; lo = hi; hi = t; }
+    qpost_clamp_s16(data, n, lo, hi);
+    for (uint32_t i = 0; i < n; i++) {
+      int16_t expected = copy[i] < lo ? lo : (copy[i] > hi ? hi : copy[i]);
+      CHECK(data[i] == expected, "clamp %d to [%d, %d]: %d", copy[i], lo, hi, data[i]);
+    }
+  }
+}
+
+static void test_argmax(void)
+{
+  int16_t data[33];
+  CHECK(qpost_argmax_s16(data, 0) == 0, "argmax of nothing");
+  for (uint32_t round = 0; round < RANDOM_ROUNDS; round++) {
+    uint32_t n = 1 + rnd() % 33;
+    // few distinct values: many ties, the first one must win
+    for (uint32_t i = 0; i < n; i++) data[i] = round % 2 ? (int16_t)rnd() : (int16_t)(rnd() % 3 - 1 + INT16_MIN * (rnd() % 2));
+    uint32_t expected = 0;
+    for (uint32_t i = 1; i < n; i++) if (data[i] > data[expected]) expected = i;
+    uint32_t got = qpost_argmax_s16(data, n);
+    CHECK(got == expected, "argmax over %u: %u, expected %u", (unsigned)n, (unsigned)got, (unsigned)expected);
+  }
+  const int16_t all_min[5] = { INT16_MIN, INT16_MIN, INT16_MIN, INT16_MIN, INT16_MIN };
+  CHECK(qpost_argmax_s16(all_min, 5) == 0, "argmax of equal values");
+}
+
+static void test_pool(void)
+{
+  int8_t in[20 * (QPOST_POOL_MAX_COLS + 3)];
+  int8_t out[20 * (QPOST_POOL_MAX_COLS + 3)];
+  for (uint32_t round = 0; round < RANDOM_ROUNDS / 4; round++) {
+    uint16_t rows = 1 + rnd() % 20, cols = 1 + rnd() % (QPOST_POOL_MAX_COLS + 3);  // also wider than the SIMD buffer
+    uint16_t win_rows = 1 + rnd() % rows, win_cols = 1 + rnd() % cols;
+    for (uint32_t i = 0; i < (uint32_t)rows * cols; i++) in[i] = round < 10 ? (int8_t)(i % 2 ? INT8_MIN : INT8_MAX) : (int8_t)rnd();
+    for (int mode = QPOST_POOL_MAX; mode <= QPOST_POOL_MIN; mode++) {
+      qpost_pool_s8(in, out, rows, cols, win_rows, win_cols, (qpost_pool_t)mode);
+      uint16_t out_rows = rows / win_rows, out_cols = cols / win_cols;
+      for (uint16_t orow = 0; orow < out_rows; orow++) {
+        for (uint16_t ocol = 0; ocol < out_cols; ocol++) {
+          int expected = mode == QPOST_POOL_MAX ? INT8_MIN : INT8_MAX;
+          for (uint16_t r = 0; r < win_rows; r++) {
+            for (uint16_t c = 0; c < win_cols; c++) {
+              int x = in[(orow * win_rows + r) * cols + ocol * win_cols + c];
+              if (mode == QPOST_POOL_MAX ? x > expected : x < expected) expected = x;
+            }
+          }
+          CHECK(out[orow * out_cols + ocol] == expected, "pool %ux%u by %ux%u mode %d at %u,%u",
+                rows, cols, win_rows, win_cols, mode, orow, ocol);
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1) seed = (uint32_t)strtoul(argv[1], NULL, 0) | 1;
+  test_scale_from_float();
+  test_dequant();
+  test_scale_clamp();
+  test_argmax();
+  test_pool();
+  qpost_bench_t bench;
+  CHECK(qpost_selftest(&bench, NULL) == 0, "selftest: %u mismatches", (unsigned)bench.mismatches);
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("qpost_test: all checks passed (SIMD path %s)\n", QPOST_SIMD ? "on" : "off, target only");
+  return EXIT_SUCCESS;
+}
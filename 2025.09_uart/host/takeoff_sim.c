@@ -0,0 +1,134 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    takeoff_sim.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Takeoff and landing time of the old step profiles against the minimum-jerk
+ segments of inc/trajectory.h, on a simulated height loop.
+
+ The closed-loop height dynamics are modelled as a second-order system
+ (natural frequency WN, damping ZETA) tracking the setpoint; setpoints are
+ held between updates like the commander does. The old takeoff ends after
+ its fixed 100-step hold, the old landing after its fixed 200 ms, and the
+ new profiles when the settle detector fires.
+
+   gcc -O2 -Iinc host/takeoff_sim.c src/trajectory.c -lm -o takeoff_sim
+   ./takeoff_sim [height]
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_main.h"
+#include "trajectory.h"
+
+#define WN          4.0f    // [rad/s] height loop natural frequency
+#define ZETA        0.9f
+#define SIM_DT_MS   1
+
+typedef struct {
+  float z, vz;
+  float peak_vz, peak_az, peak_z;
+  uint32_t t_ms;
+} plant_t;
+
+static void plant_step(plant_t *p, float z_sp)
+{
+  float dt = SIM_DT_MS * 1e-3f;
+  float az = WN * WN * (z_sp - p->z) - 2.0f * ZETA * WN * p->vz;
+  p->vz += az * dt;
+  p->z += p->vz * dt;
+  p->t_ms += SIM_DT_MS;
+  if (fabsf(p->vz) > p->peak_vz) p->peak_vz = fabsf(p->vz);
+  if (fabsf(az) > p->peak_az) p->peak_az = fabsf(az);
+  if (p->z > p->peak_z) p->peak_z = p->z;
+}
+
+// hold z_sp for ms milliseconds
+static void plant_hold(plant_t *p, float z_sp, uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; t += SIM_DT_MS) plant_step(p, z_sp);
+}
+
+static void report(const char *name, const plant_t *p, float target)
+{
+  printf("%-22s %7.2f s   z %.3f m (target %.2f, peak %.3f)   peak |vz| %.2f m/s  |az| %.2f m/s^2\n",
+         name, p->t_ms * 1e-3f, p->z, target, p->peak_z, p->peak_vz, p->peak_az);
+}
+
+int main(int argc, char **argv)
+{
+  float height = argc > 1 ? strtof(argv[1], NULL) : TARGET_H;
+  uint32_t period_ms = 1000 / SETPOINT_RATE;
+  traj_settle_config_t settle_config = { TRAJ_SETTLE_TOL, TRAJ_SETTLE_SPEED, TRAJ_SETTLE_MS, TRAJ_SETTLE_TIMEOUT_MS };
+
+  // old takeoff: +1 cm every 50 ms from 0.2 m, then 100 x 50 ms at the target
+  plant_t old = { 0 };
+  int endheight = (int)(100 * (height - 0.2f));
+  for (int i = 0; i < endheight; i++) plant_hold(&old, 0.2f + (float)i / 100.0f, 50);
+  plant_hold(&old, height, 100 * 50);
+  report("takeoff, steps", &old, height);
+
+  // new takeoff: minimum-jerk segment sampled at the setpoint rate, hold until settled
+  plant_t mj = { 0 };
+  traj_segment_t segment;
+  traj_segment_init(&segment, 0.0f, height, TRAJ_TAKEOFF_VEL, TRAJ_MAX_ACC);
+  while (mj.t_ms * 1e-3f < segment.duration) {
+    plant_hold(&mj, traj_segment_sample(&segment, mj.t_ms * 1e-3f, NULL, NULL), period_ms);
+  }
+  traj_settle_t settle;
+  traj_settle_start(&settle, mj.t_ms);
+  while (!traj_settle_update(&settle, &settle_config, mj.z - height, mj.vz, mj.t_ms)) {
+    plant_hold(&mj, height, period_ms);
+  }
+  report("takeoff, minimum-jerk", &mj, height);
+  printf("  segment %.2f s, settled %.2f s later%s\n", segment.duration, (mj.t_ms - settle.start_ms) * 1e-3f,
+         settle.timed_out ? " (timeout)" : "");
+
+  // old landing: -1 cm every 20 ms, then 200 ms; it hands over while the drone is still well above the target,
+  // so it is also run on until it meets the landing tolerance of the new one
+  traj_settle_config_t landing_config = { TRAJ_LANDING_TOL, TRAJ_LANDING_SPEED, TRAJ_LANDING_MS, TRAJ_LANDING_TIMEOUT_MS };
+  plant_t old_land = { height, 0.0f, 0.0f, 0.0f, 0.0f, 0 };
+  for (int i = (int)(100 * height); i > 100 * FINAL_LANDING_HEIGHT; i--) plant_hold(&old_land, (float)i / 100.0f, 20);
+  plant_hold(&old_land, FINAL_LANDING_HEIGHT, 200);
+  report("landing, steps", &old_land, FINAL_LANDING_HEIGHT);
+  traj_settle_start(&settle, old_land.t_ms);
+  while (!traj_settle_update(&settle, &landing_config, old_land.z - FINAL_LANDING_HEIGHT, old_land.vz, old_land.t_ms)) {
+    plant_hold(&old_land, FINAL_LANDING_HEIGHT, period_ms);
+  }
+  report("  ... until settled", &old_land, FINAL_LANDING_HEIGHT);
+
+  // new landing: minimum-jerk segment, hold until settled
+  plant_t mj_land = { height, 0.0f, 0.0f, 0.0f, 0.0f, 0 };
+  traj_segment_init(&segment, height, FINAL_LANDING_HEIGHT, TRAJ_LANDING_VEL, TRAJ_LANDING_ACC);
+  while (mj_land.t_ms * 1e-3f < segment.duration) {
+    plant_hold(&mj_land, traj_segment_sample(&segment, mj_land.t_ms * 1e-3f, NULL, NULL), period_ms);
+  }
+  traj_settle_start(&settle, mj_land.t_ms);
+  while (!traj_settle_update(&settle, &landing_config, mj_land.z - FINAL_LANDING_HEIGHT, mj_land.vz, mj_land.t_ms)) {
+    plant_hold(&mj_land, FINAL_LANDING_HEIGHT, period_ms);
+  }
+  report("landing, minimum-jerk", &mj_land, FINAL_LANDING_HEIGHT);
+  printf("  segment %.2f s, settled %.2f s later%s\n", segment.duration, (mj_land.t_ms - settle.start_ms) * 1e-3f,
+         settle.timed_out ? " (timeout)" : "");
+  return 0;
+}
@@ -0,0 +1,252 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_frame_test.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Fixed byte streams through the frame parser of inc/uart_frame.h.
+
+ Every case feeds a hand-built stream and asserts the frames delivered and
+ each parser counter: frames split at every byte boundary, a bad CRC, a
+ false sync word inside a payload, an oversize length and sequence
+ numbers wrapping at 255. Exits non-zero on failure.
+
+   gcc -O2 -Wall -Wextra -Iinc host/uart_frame_test.c src/uart_frame.c -o uart_frame_test
+   ./uart_frame_test
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uart_frame.h"
+#include "check.h"
+
+#define MAX_FRAMES    16
+#define STREAM_SIZE   1024
+
+typedef struct {
+  uint8_t bytes[STREAM_SIZE];
+  uint32_t len;
+} stream_t;
+
+typedef struct {
+  uart_frame_t frames[MAX_FRAMES];
+  uint32_t n;
+} received_t;
+
+static void on_frame(const uart_frame_t *frame, void *ctx)
+{
+  received_t *rx = (received_t *)ctx;
+  if (rx->n < MAX_FRAMES) rx->frames[rx->n] = *frame;
+  rx->n++;
+}
+
+static void put_bytes(stream_t *s, const uint8_t *bytes, uint32_t len)
+{
+  memcpy(&s->bytes[s->len], bytes, len);
+  s->len += len;
+}
+
+// append a valid frame, returns the offset of its first byte
+static uint32_t put_frame(stream_t *s, uint8_t msg_id, uint8_t seq, const uint8_t *payload, uint8_t len)
+{
+  uint32_t offset = s->len;
+  s->len += uart_frame_encode(&s->bytes[s->len], STREAM_SIZE - s->len, msg_id, seq, payload, len);
+  return offset;
+}
+
+static void parse(const stream_t *s, uart_frame_parser_t *parser, received_t *rx)
+{
+  uart_frame_parser_init(parser);
+  memset(rx, 0, sizeof(received_t));
+  uart_frame_parse(parser, s->bytes, s->len, on_frame, rx);
+}
+
+static void check_stats(const char *name, const uart_frame_stats_t *got, const uart_frame_stats_t *expected)
+{
+  CHECK(memcmp(got, expected, sizeof(uart_frame_stats_t)) == 0,
+        "%s: frames %u crc %u len %u resyncs %u dropped %u gaps %u, expected %u %u %u %u %u %u", name,
+        (unsigned)got->frames, (unsigned)got->crc_errors, (unsigned)got->len_errors, (unsigned)got->resyncs,
+        (unsigned)got->bytes_dropped, (unsigned)got->seq_gaps,
+        (unsigned)expected->frames, (unsigned)expected->crc_errors, (unsigned)expected->len_errors,
+        (unsigned)expected->resyncs, (unsigned)expected->bytes_dropped, (unsigned)expected->seq_gaps);
+}
+
+static bool frame_is(const uart_frame_t *frame, uint8_t msg_id, uint8_t seq, const uint8_t *payload, uint8_t len)
+{
+  return frame->msg_id == msg_id && frame->seq == seq && frame->len == len && memcmp(frame->payload, payload, len) == 0;
+}
+
+static const uint8_t payload_a[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+static const uint8_t payload_b[3] = { 0xA5, 0x5A, 0x00 };
+
+static void test_crc(void)
+{
+  // CRC-16/CCITT-FALSE check value
+  CHECK(uart_frame_crc16(0xFFFF, (const uint8_t *)"123456789", 9) == 0x29B1, "crc16 check value");
+}
+
+static void test_split(void)
+{
+  stream_t s = {0};
+  put_frame(&s, UART_MSG_INFERENCE, 7, payload_a, sizeof(payload_a));
+  put_frame(&s, UART_MSG_DEBUG_TEXT, 8, payload_b, sizeof(payload_b));
+  put_frame(&s, UART_MSG_CONFIG_ACK, 9, NULL, 0);
+
+  // every split point, and byte by byte: the same three frames, no error
+  for (uint32_t split = 0; split <= s.len; split++) {
+    uart_frame_parser_t parser;
+    received_t rx = {0};
+    uart_frame_parser_init(&parser);
+    uart_frame_parse(&parser, s.bytes, split, on_frame, &rx);
+    uart_frame_parse(&parser, &s.bytes[split], s.len - split, on_frame, &rx);
+    uart_frame_stats_t expected = { .frames = 3 };
+    check_stats("split", &parser.stats, &expected);
+    CHECK(rx.n == 3 && frame_is(&rx.frames[0], UART_MSG_INFERENCE, 7, payload_a, sizeof(payload_a)) &&
+          frame_is(&rx.frames[1], UART_MSG_DEBUG_TEXT, 8, payload_b, sizeof(payload_b)) &&
+          frame_is(&rx.frames[2], UART_MSG_CONFIG_ACK, 9, NULL, 0), "split at %u", (unsigned)split);
+  }
+
+  uart_frame_parser_t parser;
+  received_t rx = {0};
+  uart_frame_parser_init(&parser);
+  for (uint32_t i = 0; i < s.len; i++) uart_frame_parse(&parser, &s.bytes[i], 1, on_frame, &rx);
+  CHECK(rx.n == 3 && parser.stats.frames == 3 && parser.stats.resyncs == 0, "byte by byte");
+}
+
+static void test_bad_crc(void)
+{
+  // a payload byte flipped in the first frame: it is dropped, the second one is delivered
+  stream_t s = {0};
+  uint32_t first = put_frame(&s, UART_MSG_INFERENCE, 1, payload_a, sizeof(payload_a));
+  put_frame(&s, UART_MSG_INFERENCE, 2, payload_a, sizeof(payload_a));
+  s.bytes[first + UART_FRAME_HEADER_SIZE + 3] ^= 0x10;
+
+  uart_frame_parser_t parser;
+  received_t rx;
+  parse(&s, &parser, &rx);
+  // the whole corrupted frame (no 0xA5 inside it) is dropped in one resync
+  uart_frame_stats_t expected = { .frames = 1, .crc_errors = 1, .resyncs = 1,
+                                  .bytes_dropped = UART_FRAME_OVERHEAD + sizeof(payload_a) };
+  check_stats("bad crc", &parser.stats, &expected);
+  CHECK(rx.n == 1 && frame_is(&rx.frames[0], UART_MSG_INFERENCE, 2, payload_a, sizeof(payload_a)), "bad crc: good frame");
+}
+
+static void test_false_sync(void)
+{
+  // a valid frame whose payload holds a sync word is delivered intact
+  stream_t s = {0};
+  put_frame(&s, UART_MSG_DEBUG_TEXT, 1, payload_b, sizeof(payload_b));
+  uart_frame_parser_t parser;
+  received_t rx;
+  parse(&s, &parser, &rx);
+  uart_frame_stats_t expected = { .frames = 1 };
+  check_stats("sync in payload", &parser.stats, &expected);
+  CHECK(rx.n == 1 && frame_is(&rx.frames[0], UART_MSG_DEBUG_TEXT, 1, payload_b, sizeof(payload_b)), "sync in payload: frame");
+
+  // the first sync word is lost: the parser locks on the 0xA5 5A inside the payload.
+  // That false header claims a 0-byte payload, fails its CRC, and the next real frame is still found.
+  s.len = 0;
+  uint32_t first = put_frame(&s, UART_MSG_DEBUG_TEXT, 1, payload_b, sizeof(payload_b));
+  put_frame(&s, UART_MSG_INFERENCE, 2, payload_a, sizeof(payload_a));
+  s.bytes[first] = 0x00;
+  parse(&s, &parser, &rx);
+  uint32_t false_sync = UART_FRAME_HEADER_SIZE;                          // offset of payload_b[0]
+  uint32_t next = UART_FRAME_OVERHEAD + sizeof(payload_b);              // offset of the real frame
+  expected = (uart_frame_stats_t){ .frames = 1, .crc_errors = 1, .resyncs = 1,
+                                   .bytes_dropped = false_sync + (next - false_sync), .seq_gaps = 0 };
+  check_stats("false sync", &parser.stats, &expected);
+  CHECK(rx.n == 1 && frame_is(&rx.frames[0], UART_MSG_INFERENCE, 2, payload_a, sizeof(payload_a)), "false sync: frame");
+}
+
+static void test_oversize_len(void)
+{
+  // a header claiming UART_FRAME_MAX_PAYLOAD + 1 bytes, then a valid frame
+  stream_t s = {0};
+  const uint8_t header[] = { UART_FRAME_SYNC0, UART_FRAME_SYNC1, UART_FRAME_MAX_PAYLOAD + 1, UART_MSG_INFERENCE, 0 };
+  put_bytes(&s, header, sizeof(header));
+  put_frame(&s, UART_MSG_INFERENCE, 1, payload_a, sizeof(payload_a));
+
+  uart_frame_parser_t parser;
+  received_t rx;
+  parse(&s, &parser, &rx);
+  uart_frame_stats_t expected = { .frames = 1, .len_errors = 1, .resyncs = 1, .bytes_dropped = sizeof(header) };
+  check_stats("oversize len", &parser.stats, &expected);
+  CHECK(rx.n == 1 && frame_is(&rx.frames[0], UART_MSG_INFERENCE, 1, payload_a, sizeof(payload_a)), "oversize len: frame");
+
+  // the largest legal payload is accepted
+  uint8_t big[UART_FRAME_MAX_PAYLOAD];
+  for (uint32_t i = 0; i < sizeof(big); i++) big[i] = (uint8_t)(i * 7);
+  s.len = 0;
+  put_frame(&s, UART_MSG_TENSOR, 3, big, sizeof(big));
+  parse(&s, &parser, &rx);
+  expected = (uart_frame_stats_t){ .frames = 1 };
+  check_stats("max payload", &parser.stats, &expected);
+  CHECK(rx.n == 1 && frame_is(&rx.frames[0], UART_MSG_TENSOR, 3, big, sizeof(big)), "max payload: frame");
+}
+
+static void test_seq_wrap(void)
+{
+  // 254 255 0 1: no gap across the wrap; then 1 -> 3 misses one, 3 -> 250 misses 246, 250 -> 2 misses 7
+  const uint8_t seqs[] = { 254, 255, 0, 1, 3, 250, 2 };
+  stream_t s = {0};
+  for (uint32_t i = 0; i < sizeof(seqs); i++) put_frame(&s, UART_MSG_INFERENCE, seqs[i], payload_a, 4);
+
+  uart_frame_parser_t parser;
+  received_t rx;
+  parse(&s, &parser, &rx);
+  uart_frame_stats_t expected = { .frames = sizeof(seqs), .seq_gaps = 1 + 246 + 7 };
+  check_stats("seq wrap", &parser.stats, &expected);
+  for (uint32_t i = 0; i < sizeof(seqs) && i < rx.n; i++) CHECK(rx.frames[i].seq == seqs[i], "seq %u", (unsigned)i);
+}
+
+static void test_leading_garbage(void)
+{
+  // noise before the first frame is dropped in a single resync
+  stream_t s = {0};
+  const uint8_t noise[] = { 0x00, 0x5A, 0xA5, 0x00, 0xFF };
+  put_bytes(&s, noise, sizeof(noise));
+  put_frame(&s, UART_MSG_INFERENCE, 1, payload_a, sizeof(payload_a));
+
+  uart_frame_parser_t parser;
+  received_t rx;
+  parse(&s, &parser, &rx);
+  uart_frame_stats_t expected = { .frames = 1, .resyncs = 1, .bytes_dropped = sizeof(noise) };
+  check_stats("leading garbage", &parser.stats, &expected);
+  CHECK(rx.n == 1, "leading garbage: frame");
+}
+
+int main(void)
+{
+  test_crc();
+  test_split();
+  test_bad_crc();
+  test_false_sync();
+  test_oversize_len();
+  test_seq_wrap();
+  test_leading_garbage();
+  if (failures) {
+    printf("%d check(s) failed\n", failures);
+    return EXIT_FAILURE;
+  }
+  printf("uart_frame_test: all checks passed\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    activation.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Activation functions for CNN outputs in single precision, in three
+ accuracy tiers:
+
+   ACT_LIBM  expf() from the C library, the reference
+   ACT_POLY  2^x by range reduction and a degree-5 minimax polynomial
+   ACT_LUT   2^x by range reduction and a 65-entry table with linear interpolation
+
+ Everything is built on 2^x: exp(x) = 2^(x log2 e), sigmoid(x) = 1 / (1 + exp(-x))
+ and tanh(x) = 2 sigmoid(2x) - 1. Max error against double precision libm
+ over [-20, 20], measured with host/act_bench.c:
+
+              exp (relative)   sigmoid (absolute)   tanh (absolute)   softmax (absolute)
+   ACT_LIBM   6e-8             9e-8                 9e-8              3e-7
+   ACT_POLY   1.2e-6           1.1e-7               2.1e-7            3e-7
+   ACT_LUT    1.6e-5           3.8e-6               7.4e-6            3.7e-6
+
+ The exp error of the approximations grows with |x| because x log2 e is
+ rounded to float before the range reduction.
+
+ act_softmax() subtracts the maximum before exponentiating, so it never
+ overflows and the outputs sum to 1 (to rounding) for any finite input.
+*/
+
+#ifndef __ACTIVATION_H
+#define __ACTIVATION_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+
+typedef enum {
+  ACT_LIBM = 0,
+  ACT_POLY,
+  ACT_LUT,
+  ACT_N_TIERS,
+} act_tier_t;
+
+float act_exp2(float x, act_tier_t tier);
+float act_exp(float x, act_tier_t tier);
+float act_sigmoid(float x, act_tier_t tier);
+float act_tanh(float x, act_tier_t tier);
+/* out[i] = exp(in[i]) / sum_j exp(in[j]); in and out may be the same array */
+void act_softmax(const float *in, float *out, uint32_t n, act_tier_t tier);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
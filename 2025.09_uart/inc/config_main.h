@@ -25,11 +25,88 @@
 #define FORWARD_VELOCITY      0.0f      // Max forward speed [m/s].  Default: 1.0f
 #define TARGET_H		          0.50f     // Target height for drone's flight [m].  Default: 0.5f
 
+// DroNet control law (dronet_control.h), stepped once per inference frame
+#define CONTROL_ENABLE        1         // 0: fly straight at FORWARD_VELOCITY, ignoring the CNN
+#define CONTROL_MAX_YAW_RATE  60.0f     // [deg/s] yaw rate at full steering
+#define CONTROL_STEER_DB      0.05f     // steering dead-band
+#define CONTROL_COLL_DB       0.1f      // collision-probability dead-band
+#define CONTROL_ALPHA_SPEED   0.7f      // low-pass weight of a new speed command (DroNet: 0.7)
+#define CONTROL_ALPHA_YAW     0.5f      // low-pass weight of a new yaw-rate command (DroNet: 0.5)
+
+// Fusion of DroNet with the auxiliary networks of UART_MSG_NET_COMMAND (fusion.h)
+#define FUSION_DRONET_AGE_MS  200       // [ms] older DroNet results are rejected, and so is the fused command
+#define FUSION_NET_AGE_MS     500       // [ms] older auxiliary results are rejected
+#define FUSION_NET_WEIGHT     0.5f      // steering weight of an auxiliary network, DroNet is 1
+
 // LANDING
 #define FINAL_LANDING_HEIGHT  0.07f     // [m] --> the drone drops at 0.07m of height
 
+// Takeoff and landing trajectories (trajectory.h)
+#define TRAJ_TAKEOFF_VEL      0.5f      // [m/s] peak climb speed
+#define TRAJ_LANDING_VEL      0.5f      // [m/s] peak descent speed, as fast as the old landing and no faster near the ground
+#define TRAJ_MAX_ACC          1.0f      // [m/s^2] peak vertical acceleration of the climb
+#define TRAJ_LANDING_ACC      4.0f      // [m/s^2] and of the descent, only binds on short drops
+#define TRAJ_SETTLE_TOL       0.03f     // [m] height error that ends the post-takeoff hold
+#define TRAJ_SETTLE_SPEED     0.05f     // [m/s] and vertical speed
+#define TRAJ_SETTLE_MS        200       // [ms] both within tolerance for this long
+#define TRAJ_SETTLE_TIMEOUT_MS 5000     // [ms] longest hold, the old fixed one
+#define TRAJ_LANDING_TOL      0.03f     // [m] height error above FINAL_LANDING_HEIGHT that ends the landing hold
+#define TRAJ_LANDING_SPEED    0.1f      // [m/s] and vertical speed
+#define TRAJ_LANDING_MS       50        // [ms] both within tolerance for this long
+#define TRAJ_LANDING_TIMEOUT_MS 1000    // [ms] longest landing hold
+
+// PATHS (path.h), flown by the "circle" manouver from the current position
+#define PATH_TYPE             PATH_CIRCLE // circle, figure-8, lemniscate, polygon or spline, tunable at runtime
+#define PATH_SIZE             0.5f      // [m] radius or half-width
+#define PATH_SPEED            0.5f      // [m/s] along the path
+#define PATH_SIDES            4         // polygon
+#define PATH_LAPS             1         // closed paths
+#define PATH_WAYPOINTS        {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}} // [m] spline, at most PATH_MAX_WAYPOINTS
+#define PATH_WAYPOINTS_CLOSED 1         // spline: back to the first waypoint
+
 // SPINNING
 #define SPIN_TIME             1500.0    // [ms]
 #define SPIN_YAW_RATE         90.0      // [deg/s]
 #define SPIN_ANGLE 	          180.0     // [deg]
 #define RANDOM_SPIN_ANGLE     90.0      // [deg] add randomness to SPIN_ANGLE +/- RANDOM_SPIN_ANGLE
+
+// CNN post-processing
+#define ACTIVATION_TIER       ACT_POLY  // sigmoid/softmax accuracy: ACT_LIBM, ACT_POLY or ACT_LUT (see activation.h)
+#define DECODE_ACT_TIER       ACTIVATION_TIER // activations of the output decoders (decoder.h)
+#define FILTER_STEERING       FILTER_ONE_EURO // temporal filter of each CNN output (filter_bank.h), tunable at runtime
+#define FILTER_COLLISION      FILTER_EMA
+#define FILTER_ALPHA          0.3f      // EMA: weight of a new sample at 30 fps
+#define FILTER_MEDIAN_N       5         // median: window length
+#define FILTER_MIN_CUTOFF     1.0f      // [Hz] 1-euro: cutoff when the output is still
+#define FILTER_BETA           0.5f      // 1-euro: speed coefficient
+#define FILTER_D_CUTOFF       1.0f      // [Hz] 1-euro: cutoff of the speed estimate
+#define FILTER_KF_Q           0.5f      // Kalman: process noise per second
+#define FILTER_KF_R           0.01f     // Kalman: measurement noise
+
+// UART (AI-deck link)
+#define UART_RX_DOUBLE_BUFFER 1         // 1: ping-pong DMA buffers handed out zero-copy, 0: circular ring copied out
+#define UART_RX_BUFFER_SIZE   128       // [byte] per RX DMA buffer (ring half), any frame size fits
+#define UART_IDLE_POLL_MS     1         // [ms] the UART task polls the IDLE line at least this often
+#define UART_HIGH_SPEED       1         // 1: negotiate a faster baud rate with the AI-deck at runtime
+#define UART_HIGH_SPEED_RATES {3000000, 2000000, 1000000, 0} // [baud] tried fastest first, 0-terminated
+#define NEMO_QUANTUM          0.0006f   // default scale of every CNN output until the AI-deck sends its quantization table
+#define DEPTH_GRID_ROWS       8         // int8 depth grid streamed by the GAP9 as UART_MSG_TENSOR chunks
+#define DEPTH_GRID_COLS       8
+#define DEPTH_GRID_SCALE      0.02f     // [m] per LSB
+#define DEPTH_GRID_ZERO       -128      // raw value of 0 m
+#define DEPTH_GRID_RANGE      5.0f      // [m] farther readings are clamped
+#define CLASSIFIER_CLASSES    4         // built-in classifier decoder (networks.h)
+#define CLASSIFIER_SCALE      0.125f    // logit per LSB
+#define STATE_STREAM_RATE     20        // [Hz] state snapshots sent to the AI-deck, 0 = off
+#define UART_TASK_STACKSIZE   (3*configMINIMAL_STACK_SIZE) // UART consumer task, runs next to the flight loop
+#define UART_TASK_PRI         2         // above the app task (CONFIG_APP_PRIORITY)
+#define SETPOINT_RATE         100       // [Hz] setpoints streamed to the commander, tunable at runtime
+#define SETPOINT_TASK_STACKSIZE (2*configMINIMAL_STACK_SIZE)
+#define SETPOINT_TASK_PRI     3         // above every writer of the setpoint buffer
+
+// AI-deck link watchdog: graded failsafe when inference frames stop arriving in flight
+#define WATCHDOG_ENABLE       0         // off: the quickstart flies without a streaming AI-deck
+#define WATCHDOG_SLOW_MS      300       // [ms] no frame for this long: slow down
+#define WATCHDOG_HOVER_MS     1000      // [ms] hover in place
+#define WATCHDOG_LAND_MS      5000      // [ms] land
+#define WATCHDOG_SLOW_FACTOR  0.5f      // forward speed multiplier while slowed down
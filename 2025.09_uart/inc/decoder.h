@@ -0,0 +1,144 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    decoder.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Compile-time output decoders for CNN heads.
+
+ A network is described by an X-macro list of heads (see networks.h):
+
+   HEAD(name, offset, length, dtype, scale, zero_point, activation, lo, hi)
+
+   offset      [byte] of the first element in the raw output
+   length      number of elements
+   dtype       DECODE_INT8, DECODE_INT16 or DECODE_INT32 (little-endian)
+   scale       real value = (q - zero_point) * scale; DECODE_RUNTIME_SCALE takes
+               them from the quant[] table passed to the decoder instead, one
+               entry per head in list order (updatable without a reflash)
+   activation  DECODE_ACT_NONE, _SIGMOID, _TANH or _SOFTMAX (over the head)
+   lo, hi      clamp range applied last, -FLT_MAX, FLT_MAX to skip it
+
+ DECODER_DEFINE(net, HEADS) then generates
+   net_output_t                a struct with one float array per head
+   net_decode(raw, quant, out) the decoder, with every table entry inlined as
+                               a constant so nothing is interpreted at runtime;
+                               quant may be NULL if no head is DECODE_RUNTIME_SCALE
+   net_heads[]                 the table itself, for names and introspection
+   net_BYTES                   raw size of contiguous heads
+   net_HEADS                   number of heads, the size of quant[]
+*/
+
+#ifndef __DECODER_H
+#define __DECODER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+#include "activation.h"
+
+#ifndef DECODE_ACT_TIER
+#define DECODE_ACT_TIER     ACT_POLY
+#endif
+
+#define DECODE_RUNTIME_SCALE  0.0f
+
+typedef enum { DECODE_INT8 = 1, DECODE_INT16 = 2, DECODE_INT32 = 4 } decode_dtype_t;  // value = size in bytes
+typedef enum { DECODE_ACT_NONE = 0, DECODE_ACT_SIGMOID, DECODE_ACT_TANH, DECODE_ACT_SOFTMAX } decode_act_t;
+
+typedef struct {
+  const char *name;
+  uint16_t offset;
+  uint16_t length;
+  decode_dtype_t dtype;
+  float scale;
+  int32_t zero_point;
+  decode_act_t activation;
+  float lo, hi;
+} decoder_head_t;
+
+// Runtime dequantization of one DECODE_RUNTIME_SCALE head
+typedef struct {
+  float scale;
+  int32_t zero_point;
+} decode_quant_t;
+
+static inline __attribute__((always_inline)) int32_t decode_load(const uint8_t *p, decode_dtype_t dtype)
+{
+  if (dtype == DECODE_INT8) return (int8_t)p[0];
+  if (dtype == DECODE_INT16) return (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+  return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+// Called with constant arguments only: the dtype, activation and clamp branches fold away
+static inline __attribute__((always_inline)) void decode_head(const uint8_t *raw, uint16_t offset, uint16_t length,
+    decode_dtype_t dtype, float scale, int32_t zero_point, decode_act_t activation, float lo, float hi,
+    const decode_quant_t *quant, float *out)
+{
+  if (scale == DECODE_RUNTIME_SCALE) {
+    scale = quant->scale;
+    zero_point = quant->zero_point;
+  }
+  for (uint16_t i = 0; i < length; i++) {
+    float x = (float)(decode_load(&raw[offset + i * dtype], dtype) - zero_point) * scale;
+    if (activation == DECODE_ACT_SIGMOID) x = act_sigmoid(x, DECODE_ACT_TIER);
+    if (activation == DECODE_ACT_TANH) x = act_tanh(x, DECODE_ACT_TIER);
+    out[i] = x;
+  }
+  if (activation == DECODE_ACT_SOFTMAX) {
+    act_softmax(out, out, length, DECODE_ACT_TIER);
+  }
+  if (lo != -FLT_MAX || hi != FLT_MAX) {
+    for (uint16_t i = 0; i < length; i++) {
+      if (out[i] < lo) out[i] = lo;
+      if (out[i] > hi) out[i] = hi;
+    }
+  }
+}
+
+#define DECODER_FIELD_(name, offset, length, dtype, scale, zp, act, lo, hi) float name[length];
+#define DECODER_INDEX_(name, offset, length, dtype, scale, zp, act, lo, hi) decode_index_##name,
+#define DECODER_STEP_(name, offset, length, dtype, scale, zp, act, lo, hi) \
+  decode_head(raw, offset, length, dtype, scale, zp, act, lo, hi, \
+              (scale) == DECODE_RUNTIME_SCALE ? &quant[decode_index_##name] : NULL, out->name);
+#define DECODER_DESC_(name, offset, length, dtype, scale, zp, act, lo, hi) \
+  { #name, offset, length, dtype, scale, zp, act, lo, hi },
+#define DECODER_BYTES_(name, offset, length, dtype, scale, zp, act, lo, hi) + (length) * (dtype)
+
+#define DECODER_DEFINE(net, HEADS) \
+  typedef struct { HEADS(DECODER_FIELD_) } net##_output_t; \
+  enum { net##_BYTES = 0 HEADS(DECODER_BYTES_) }; \
+  static const decoder_head_t net##_heads[] __attribute__((unused)) = { HEADS(DECODER_DESC_) }; \
+  enum { net##_HEADS = sizeof(net##_heads) / sizeof(net##_heads[0]) }; \
+  static inline void net##_decode(const uint8_t *raw, const decode_quant_t *quant, net##_output_t *out) \
+  { \
+    enum { HEADS(DECODER_INDEX_) }; \
+    HEADS(DECODER_STEP_) \
+  }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    dronet_control.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ DroNet control law (Loquercio et al., RA-L 2018): CNN outputs -> forward
+ speed and yaw rate, stepped once per inference frame.
+
+   speed    = (1 - a_speed) * speed    + a_speed * (1 - collision) * max_speed
+   yaw_rate = (1 - a_yaw)   * yaw_rate + a_yaw   * steering * max_yaw_rate
+
+ collision is a probability and steering lies in [-1, 1]; positive steering
+ turns left (counter-clockwise seen from above). Inside the dead-bands the
+ inputs count as 0, above them the range is stretched back to [0, 1], so the
+ commands stay continuous. Both filters start from rest (hover) after
+ dronet_control_reset().
+*/
+
+#ifndef __DRONET_CONTROL_H
+#define __DRONET_CONTROL_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+  float max_speed;        // [m/s] forward speed with no collision
+  float max_yaw_rate;     // [deg/s] yaw rate at full steering
+  float steer_deadband;   // |steering| below this is ignored
+  float coll_deadband;    // collision probability below this is ignored
+  float alpha_speed;      // low-pass weight of a new speed command, (0, 1]
+  float alpha_yaw;        // low-pass weight of a new yaw-rate command, (0, 1]
+} dronet_control_config_t;
+
+typedef struct {
+  float speed;            // [m/s] forward speed command
+  float yaw_rate;         // [deg/s] yaw-rate command
+  uint32_t steps;
+} dronet_control_t;
+
+void dronet_control_reset(dronet_control_t *control);
+/* Update the commands with the outputs of one frame */
+void dronet_control_step(const dronet_control_config_t *config, dronet_control_t *control,
+                         float steering, float collision);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,94 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    filter_bank.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Temporal filters for CNN outputs, one state per channel and fixed memory.
+
+   FILTER_EMA       exponential moving average; alpha is the weight of a new
+                    sample at the nominal period FILTER_NOMINAL_DT and is
+                    converted to a time constant, so late frames weigh more
+   FILTER_MEDIAN    median of the last median_n samples (odd, <= FILTER_MEDIAN_MAX)
+   FILTER_ONE_EURO  1-euro filter (Casiez et al., CHI 2012): the cutoff rises
+                    with the speed of the signal, smooth when still, low lag when moving
+   FILTER_KALMAN    scalar Kalman filter on a random walk: process noise q
+                    per second, measurement noise r
+
+ Time steps come from the frame timestamps. A gap longer than
+ FILTER_MAX_GAP_US (or a change of filter type) restarts the filter
+ from the next sample. The config can be changed at any time (params).
+*/
+
+#ifndef __FILTER_BANK_H
+#define __FILTER_BANK_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FILTER_MEDIAN_MAX   9
+#define FILTER_NOMINAL_DT   (1.0f / 30.0f)  // [s] frame period alpha refers to
+#define FILTER_MAX_GAP_US   500000          // [us]
+
+typedef enum {
+  FILTER_NONE = 0,
+  FILTER_EMA,
+  FILTER_MEDIAN,
+  FILTER_ONE_EURO,
+  FILTER_KALMAN,
+  FILTER_N_TYPES,
+} filter_type_t;
+
+typedef struct {
+  uint8_t type;           // filter_type_t
+  float alpha;            // EMA: weight of a new sample at FILTER_NOMINAL_DT, (0, 1]
+  uint8_t median_n;       // median: window length
+  float min_cutoff;       // 1-euro: [Hz] cutoff when the signal is still
+  float beta;             // 1-euro: cutoff increase per unit of signal speed
+  float d_cutoff;         // 1-euro: [Hz] cutoff of the speed estimate
+  float q;                // Kalman: process noise [unit^2/s]
+  float r;                // Kalman: measurement noise [unit^2]
+} filter_config_t;
+
+typedef struct {
+  uint8_t type;           // filter the state was built for
+  bool init;
+  uint32_t last_us;
+  float y;                // output
+  float x_prev;           // 1-euro: last input
+  float dx;               // 1-euro: filtered speed
+  float p;                // Kalman: variance of y
+  float window[FILTER_MEDIAN_MAX];
+  uint8_t count, head;
+} filter_state_t;
+
+void filter_reset(filter_state_t *state);
+/* Filter sample x taken at t_us, returns the filtered value */
+float filter_update(const filter_config_t *config, filter_state_t *state, float x, uint32_t t_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    fusion.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Fusion of the results of several networks into one command.
+
+ Every network (source) has one slot holding its latest result: a proposed
+ steering, the fraction of the maximum speed it allows, a confidence and the
+ time the result refers to. Producers overwrite their slot at any rate
+ (fusion_publish(), interrupt-safe: one writer per slot, published with a
+ sequence lock). fusion_tick() reads every slot at the control tick and
+ ages the results against the same "now":
+
+   age > max_age_us     rejected
+   steering             average weighted by weight * confidence * (1 - age / max_age)
+   speed                the most restrictive limit, min over 1 - confidence * (1 - speed),
+                        not relaxed with age: a stop request holds until it expires
+
+ The output is valid only if every required source has a fresh result;
+ otherwise it is steering 0, speed 0. Fixed memory, no allocation.
+*/
+
+#ifndef __FUSION_H
+#define __FUSION_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FUSION_MAX_SOURCES    4
+#define FUSION_READ_RETRIES   4   // attempts to read a slot the producer keeps rewriting
+
+typedef struct {
+  float steering;         // [-1, 1], positive turns left
+  float speed;            // [0, 1] fraction of the maximum forward speed allowed
+  float confidence;       // [0, 1]
+} fusion_command_t;
+
+typedef struct {
+  uint8_t enable;
+  uint8_t required;       // no valid output without a fresh result from this source
+  float weight;           // steering weight of a fresh, fully confident result
+  uint32_t max_age_us;    // [us] older results are rejected
+} fusion_source_config_t;
+
+typedef struct {
+  uint32_t seq;           // odd while the producer writes, 0 before the first result
+  uint32_t t_us;          // [us] time the result refers to
+  fusion_command_t command;
+} fusion_slot_t;
+
+typedef struct {
+  fusion_command_t command; // fused; confidence = sum of the weights used / sum of the weights enabled
+  bool valid;
+  uint8_t used;           // bit mask of the sources that contributed
+  uint32_t t_newest_us;   // [us] newest result used
+  uint32_t age_max_us;    // [us] oldest result used
+} fusion_output_t;
+
+typedef struct {
+  fusion_source_config_t config[FUSION_MAX_SOURCES];
+  fusion_slot_t slots[FUSION_MAX_SOURCES];
+  // producer side
+  uint32_t published[FUSION_MAX_SOURCES];
+  // consumer side
+  uint32_t used[FUSION_MAX_SOURCES];
+  uint32_t rejected[FUSION_MAX_SOURCES];  // stale results found at a tick
+  uint32_t ticks;
+  uint32_t invalid;       // ticks without a fresh required source
+  uint32_t torn;          // slots skipped because the producer kept rewriting them
+} fusion_t;
+
+// every source starts disabled
+void fusion_init(fusion_t *fusion);
+/* Producer of "source": store its latest result, taken at t_us */
+void fusion_publish(fusion_t *fusion, uint8_t source, uint32_t t_us, const fusion_command_t *command);
+/* Consumer: fuse the slots at now_us, returns out->valid */
+bool fusion_tick(fusion_t *fusion, uint32_t now_us, fusion_output_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    inference_queue.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Single-producer/single-consumer ring of decoded inference results.
+ The producer is the UART RX DMA interrupt, the consumer is the app task.
+ Fixed capacity, no allocation and no locks: head is written only by the
+ producer, tail only by the consumer, and both are published with
+ acquire/release atomics so the same code runs on a host with two threads.
+ When the ring is full the newest record is dropped and counted.
+*/
+
+#ifndef __INFERENCE_QUEUE_H
+#define __INFERENCE_QUEUE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define INFERENCE_QUEUE_SIZE    8   // records, must be a power of two
+#define INFERENCE_MAX_OUTPUTS   2   // CNN outputs per record, widened to int32
+
+typedef struct {
+  uint32_t timestamp;                       // [us] arrival time of the frame (DMA interrupt)
+  uint32_t t_irq;                           // [cycles] DMA interrupt entry, see latency_trace.h
+  uint32_t t_decode;                        // [cycles] frame decoded
+  uint8_t seq;                              // frame sequence number
+  uint8_t n_outputs;
+  int32_t outputs[INFERENCE_MAX_OUTPUTS];  // quantized, output = (q - zero_point) * scale
+  int32_t zero_point[INFERENCE_MAX_OUTPUTS]; // per output, as of the frame's arrival
+  float scale[INFERENCE_MAX_OUTPUTS];
+} inference_record_t;
+
+typedef struct {
+  inference_record_t records[INFERENCE_QUEUE_SIZE];
+  uint32_t head;        // next slot to write, producer-owned
+  uint32_t tail;        // next slot to read, consumer-owned
+  uint32_t pushed;
+  uint32_t overflows;   // records dropped because the ring was full
+  uint32_t high_water;  // largest depth observed by the producer
+} inference_queue_t;
+
+void inference_queue_init(inference_queue_t *queue);
+// producer side: false (and overflows++) if the ring is full
+bool inference_queue_push(inference_queue_t *queue, const inference_record_t *record);
+// consumer side: false if the ring is empty
+bool inference_queue_pop(inference_queue_t *queue, inference_record_t *record);
+uint32_t inference_queue_count(const inference_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    latency_trace.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ End-to-end latency tracing of inference frames.
+
+ Each frame is stamped with a free-running cycle counter (DWT->CYCCNT on the
+ STM32) at four points: DMA interrupt entry, decode, post-processing and
+ the commanderSetSetpoint() that uses it. Completed traces go to a fixed
+ ring; for every stage the tracer keeps min, mean and a p99 estimate from
+ a log-linear histogram (4 buckets per octave, ~19% resolution).
+
+ latency_trace_begin() (UART task) hands the pending trace to
+ latency_trace_setpoint() (setpoint task, higher priority) like
+ setpoint_buffer.h: it marks the write as started, fills the entry and
+ publishes it by bumping a sequence number (release). The reader copies
+ the entry of the sequence it loaded (acquire) and leaves it for the next
+ setpoint if a new write started meanwhile. Only the reader touches the
+ ring and the statistics. No firmware dependency.
+*/
+
+#ifndef __LATENCY_TRACE_H
+#define __LATENCY_TRACE_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  TRACE_IRQ = 0,    // DMA interrupt entry
+  TRACE_DECODE,     // frame decoded by the channel handler
+  TRACE_POSTPROC,   // CNN outputs post-processed by the UART task
+  TRACE_SETPOINT,   // setpoint computed from them sent to the commander
+  TRACE_POINTS,
+} trace_point_t;
+
+// Intervals with statistics: one per stage plus the end-to-end latency
+typedef enum {
+  TRACE_STAGE_DECODE = 0,   // IRQ -> decode
+  TRACE_STAGE_POSTPROC,     // decode -> post-processing
+  TRACE_STAGE_SETPOINT,     // post-processing -> setpoint
+  TRACE_STAGE_TOTAL,        // IRQ -> setpoint
+  TRACE_STAGES,
+} trace_stage_t;
+
+#define TRACE_RING_SIZE       32
+#define TRACE_HIST_OCTAVES    22  // covers 2^4 .. 2^26 cycles (0.1 us .. 400 ms at 168 MHz)
+#define TRACE_HIST_SUB        4
+#define TRACE_HIST_BINS       (TRACE_HIST_OCTAVES * TRACE_HIST_SUB)
+
+typedef struct {
+  uint8_t seq;
+  uint32_t t[TRACE_POINTS];   // [cycles]
+} trace_entry_t;
+
+typedef struct {
+  uint16_t hist[TRACE_HIST_BINS];
+  uint32_t count;
+  uint64_t sum;               // [cycles]
+  uint32_t min;               // [cycles]
+  // exported, in microseconds
+  float min_us;
+  float mean_us;
+  float p99_us;
+} trace_stats_t;
+
+typedef struct {
+  trace_entry_t ring[TRACE_RING_SIZE];
+  uint32_t head;              // completed traces so far
+  trace_entry_t pending;      // waiting for its setpoint
+  uint32_t pending_started;   // writer: sequence being written
+  uint32_t pending_seq;       // writer: last sequence published
+  uint32_t taken_seq;         // reader: last sequence closed
+  float cycles_per_us;
+  trace_stats_t stats[TRACE_STAGES];
+} latency_trace_t;
+
+void latency_trace_init(latency_trace_t *trace, float cycles_per_us);
+/* Open a trace once a frame is post-processed; replaces a pending trace that never reached a setpoint. */
+void latency_trace_begin(latency_trace_t *trace, uint8_t seq, uint32_t t_irq, uint32_t t_decode, uint32_t t_postproc);
+/* Close the pending trace, if any, when a setpoint is sent. */
+void latency_trace_setpoint(latency_trace_t *trace, uint32_t t_setpoint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,104 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    link_health.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Health of the AI-deck inference stream and the failsafe built on it.
+
+ link_health_frame() is called by the receiver for every inference frame
+ (DMA interrupt on the Crazyflie) and keeps incremental statistics of the
+ inter-arrival time: smoothed period, jitter (mean absolute deviation,
+ gain 1/16 as in RFC 3550) and the longest gap. link_health_window() is
+ called by the app task to turn frame and error counters into rates.
+
+ The watchdog grades the age of the last frame: LINK_SLOW after slow_ms,
+ LINK_HOVER after hover_ms, LINK_LAND after land_ms. SLOW and HOVER clear
+ as soon as frames arrive again; LAND is latched until the next
+ link_watchdog_arm(). No firmware dependency: times are passed in.
+*/
+
+#ifndef __LINK_HEALTH_H
+#define __LINK_HEALTH_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LINK_SKEW_US  1000000u      // [us] a last frame at most this much newer than now_us is 0 old
+
+typedef struct {
+  // producer side (interrupt)
+  uint32_t frames;
+  uint32_t last_us;         // [us] arrival of the last frame
+  float period_us;          // [us] smoothed inter-arrival time
+  float jitter_us;          // [us] smoothed deviation from period_us
+  uint32_t gap_max_us;      // [us] longest inter-arrival time
+  // consumer side (app task)
+  uint32_t window_start_us;
+  uint32_t window_frames;
+  uint32_t window_errors;
+  float rate_hz;            // [Hz] frames over the last window
+  float error_rate_hz;      // [Hz] link errors over the last window
+} link_health_t;
+
+typedef enum {
+  LINK_OK = 0,
+  LINK_SLOW,                // reduce the forward speed
+  LINK_HOVER,               // hold the position
+  LINK_LAND,                // land and stop
+  LINK_N_LEVELS,
+} link_level_t;
+
+typedef struct {
+  uint32_t slow_ms;
+  uint32_t hover_ms;
+  uint32_t land_ms;
+} link_watchdog_config_t;
+
+typedef struct {
+  link_watchdog_config_t config;
+  uint32_t armed_ms;        // [ms] the age of the link is never counted from before this
+  uint8_t level;            // link_level_t
+  uint32_t trips[LINK_N_LEVELS]; // entries into each level
+} link_watchdog_t;
+
+void link_health_init(link_health_t *health, uint32_t now_us);
+// producer: one inference frame arrived at now_us
+void link_health_frame(link_health_t *health, uint32_t now_us);
+// consumer: update rate_hz and error_rate_hz once window_us has elapsed, errors is a cumulative counter
+void link_health_window(link_health_t *health, uint32_t now_us, uint32_t window_us, uint32_t errors);
+// consumer: [us] since the last frame, 0 if the last frame is up to LINK_SKEW_US newer than now_us
+uint32_t link_health_age_us(const link_health_t *health, uint32_t now_us);
+
+void link_watchdog_init(link_watchdog_t *wd, const link_watchdog_config_t *config);
+// start supervising (e.g. after takeoff), clears a latched LINK_LAND
+void link_watchdog_arm(link_watchdog_t *wd, uint32_t now_ms);
+// grade the link from the age of the last frame, returns the new level
+link_level_t link_watchdog_step(link_watchdog_t *wd, uint32_t now_ms, uint32_t age_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    maneuver.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Manoeuvres as resumable state machines, driven one step per control tick.
+
+ A manoeuvre is a step function written as a coroutine: MANEUVER_BEGIN,
+ MANEUVER_YIELD, MANEUVER_WAIT_UNTIL and MANEUVER_END expand to a switch on
+ the line of the last yield, so each call resumes where the previous one
+ returned and never blocks. Locals do not survive a yield: keep the state
+ in the context, and do not use switch statements inside the body.
+
+ The executor runs at most one manoeuvre. The flight loop calls
+ maneuver_tick() once per control period, and everything else it does
+ (link watchdog, stop requests) still runs every tick; maneuver_abort()
+ preempts the manoeuvre before its next step.
+*/
+
+#ifndef __MANEUVER_H
+#define __MANEUVER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+  MANEUVER_RUNNING = 0,
+  MANEUVER_DONE,
+} maneuver_status_t;
+
+typedef struct maneuver_s maneuver_t;
+typedef maneuver_status_t (*maneuver_step_t)(maneuver_t *maneuver, uint32_t now_ms);
+
+struct maneuver_s {
+  maneuver_step_t step;
+  void *ctx;              // state kept across steps
+  uint32_t line;          // resume point, 0 at the start
+  uint32_t start_ms;      // [ms] launch time, the now_ms of maneuver_start()
+};
+
+#define MANEUVER_BEGIN(m)   switch ((m)->line) { case 0:
+#define MANEUVER_YIELD(m)   do { (m)->line = __LINE__; return MANEUVER_RUNNING; case __LINE__:; } while (0)
+#define MANEUVER_WAIT_UNTIL(m, cond) \
+  do { (m)->line = __LINE__; __attribute__((fallthrough)); case __LINE__: if (!(cond)) return MANEUVER_RUNNING; } while (0)
+#define MANEUVER_END(m)     } (m)->line = 0; return MANEUVER_DONE
+
+typedef struct {
+  maneuver_t current;
+  uint8_t id;             // caller-defined id of the running manoeuvre, 0 when idle
+  uint32_t steps;         // steps of the running manoeuvre
+  uint32_t started;
+  uint32_t completed;
+  uint32_t preempted;
+} maneuver_executor_t;
+
+void maneuver_executor_init(maneuver_executor_t *executor);
+/* Start manoeuvre "id" (not 0); false if another one is running */
+bool maneuver_start(maneuver_executor_t *executor, uint8_t id, maneuver_step_t step, void *ctx, uint32_t now_ms);
+/* Preempt the running manoeuvre, if any, before its next step */
+void maneuver_abort(maneuver_executor_t *executor);
+bool maneuver_active(const maneuver_executor_t *executor);
+/* One step of the running manoeuvre; true if one ran (and wrote its setpoint) */
+bool maneuver_tick(maneuver_executor_t *executor, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,52 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    networks.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Built-in output decoders (see decoder.h for the head fields).
+ Add a network by writing its HEADS list and one DECODER_DEFINE().
+*/
+
+#ifndef __NETWORKS_H
+#define __NETWORKS_H
+
+#include "config_main.h"
+#include "decoder.h"
+
+// DroNet: steering angle and collision probability, each with its own runtime scale and zero point
+// (quantization table set by UART_MSG_QUANT_TABLE or the QUANT_PAR params), see process_cnn_output()
+#define DRONET_HEADS(HEAD) \
+  HEAD(steering,  0, 1, DECODE_INT32, DECODE_RUNTIME_SCALE, 0, DECODE_ACT_NONE, -1.0f, 1.0f) \
+  HEAD(collision, 4, 1, DECODE_INT32, DECODE_RUNTIME_SCALE, 0, DECODE_ACT_NONE, -FLT_MAX, FLT_MAX)
+DECODER_DEFINE(dronet, DRONET_HEADS)
+
+// Classifier: int8 logits of CLASSIFIER_CLASSES classes turned into probabilities
+#define CLASSIFIER_HEADS(HEAD) \
+  HEAD(probs, 0, CLASSIFIER_CLASSES, DECODE_INT8, CLASSIFIER_SCALE, 0, DECODE_ACT_SOFTMAX, -FLT_MAX, FLT_MAX)
+DECODER_DEFINE(classifier, CLASSIFIER_HEADS)
+
+// Depth: int8 grid streamed as UART_MSG_TENSOR chunks, in meters
+#define DEPTH_HEADS(HEAD) \
+  HEAD(depth, 0, DEPTH_GRID_ROWS * DEPTH_GRID_COLS, DECODE_INT8, DEPTH_GRID_SCALE, DEPTH_GRID_ZERO, \
+       DECODE_ACT_NONE, 0.0f, DEPTH_GRID_RANGE)
+DECODER_DEFINE(depth, DEPTH_HEADS)
+
+#endif
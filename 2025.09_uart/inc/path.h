@@ -0,0 +1,91 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    path.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Parametric paths in the horizontal plane, flown at constant speed.
+
+   PATH_CIRCLE      radius "size"
+   PATH_FIGURE8     Gerono lemniscate, x = size sin(u), y = size sin(u) cos(u)
+   PATH_LEMNISCATE  Bernoulli lemniscate, half-width "size"
+   PATH_POLYGON     regular, "sides" vertices on a circle of radius "size"
+   PATH_SPLINE      Catmull-Rom spline through up to PATH_MAX_WAYPOINTS points
+
+ path_init() walks the shape twice along its own parameter: once to measure
+ its length, once to store PATH_TABLE_SIZE + 1 points equally spaced in arc
+ length (constant-speed reparameterization). The trigonometric shapes are
+ generated by rotating a unit vector by a fixed angle, so the whole build
+ costs one sinf/cosf pair. path_sample() then interpolates the table: no
+ libm, no search, constant time. Paths are closed except open splines, and
+ start at the origin; callers add their own offset.
+*/
+
+#ifndef __PATH_H
+#define __PATH_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PATH_TABLE_SIZE       128   // arc-length segments of the table
+#define PATH_BUILD_STEPS      1024  // steps along the shape parameter while building
+#define PATH_MAX_WAYPOINTS    8
+
+typedef enum {
+  PATH_CIRCLE = 0,
+  PATH_FIGURE8,
+  PATH_LEMNISCATE,
+  PATH_POLYGON,
+  PATH_SPLINE,
+  PATH_N_TYPES,
+} path_type_t;
+
+typedef struct {
+  uint8_t type;           // path_type_t
+  float size;             // [m] radius or half-width
+  uint8_t sides;          // polygon
+  uint8_t n_waypoints;    // spline
+  bool closed;            // spline: back to the first waypoint
+  float waypoints[PATH_MAX_WAYPOINTS][2];  // [m] spline, relative to the start
+} path_config_t;
+
+typedef struct {
+  float table[PATH_TABLE_SIZE + 1][2];  // [m] points equally spaced in arc length, from the start
+  float length;           // [m]
+  float step;             // [m] arc length between table points
+  float inv_step;
+  bool closed;
+} path_t;
+
+/* Build the table of "config"; false (and an empty path) if the config is invalid */
+bool path_init(path_t *path, const path_config_t *config);
+/* Point at arc length s [m] from the start, wrapping around closed paths and
+   clamped on open ones; optionally the unit tangent */
+void path_sample(const path_t *path, float s, float *x, float *y, float *tx, float *ty);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
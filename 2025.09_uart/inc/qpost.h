@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    qpost.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Fixed-point post-processing kernels for quantized CNN outputs.
+
+ Values are int16 in a Q-format chosen by the caller (QPOST_FRAC_BITS by
+ default). A real scale is turned once into an integer multiplier and a
+ right shift, so every kernel is integer-only:
+
+   out = sat16((sat16(q - zero_point) * mult) >> shift)
+
+ q - zero_point only leaves int16 for |zero_point| > 32640; it then
+ saturates (__QSUB16 on the M4) instead of wrapping.
+
+ Each kernel has a portable C reference (qpost_ref_*). The public names use the
+ Cortex-M4 DSP SIMD instructions (two int16 or four int8 lanes per word)
+ when the compiler targets them (__ARM_FEATURE_DSP), otherwise they are the
+ reference. Both paths round the same way (arithmetic shift, i.e. towards
+ minus infinity) and saturate the same way, so results are bit-exact.
+ qpost_selftest() checks this on the target and measures cycles per element.
+*/
+
+#ifndef __QPOST_H
+#define __QPOST_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define QPOST_FRAC_BITS     12    // default Q3.12: [-8, 8) with a resolution of 1/4096
+#define QPOST_POOL_MAX_COLS 64    // widest input of qpost_pool_s8()
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define QPOST_SIMD 1
+#else
+#define QPOST_SIMD 0
+#endif
+
+typedef struct {
+  int16_t mult;
+  uint8_t shift;
+} qpost_scale_t;
+
+typedef enum {
+  QPOST_POOL_MAX = 0,
+  QPOST_POOL_MIN,
+} qpost_pool_t;
+
+/* Multiplier and shift so that q * scale in Q(frac_bits) is (q * mult) >> shift */
+qpost_scale_t qpost_scale_from_float(float scale, uint8_t frac_bits);
+
+/* out[i] = sat16((sat16(in[i] - zero_point) * mult) >> shift) */
+void qpost_dequant_s8(const int8_t *in, int16_t *out, uint32_t n, int16_t zero_point, qpost_scale_t scale);
+/* data[i] = min(max(data[i], lo), hi) */
+void qpost_clamp_s16(int16_t *data, uint32_t n, int16_t lo, int16_t hi);
+/* data[i] = sat16((data[i] * mult) >> shift) */
+void qpost_scale_s16(int16_t *data, uint32_t n, qpost_scale_t scale);
+/* index of the first largest element, 0 if n is 0 */
+uint32_t qpost_argmax_s16(const int16_t *data, uint32_t n);
+/* max/min over non-overlapping win_rows x win_cols windows of a rows x cols grid;
+   out is (rows / win_rows) x (cols / win_cols), leftover rows and columns are ignored */
+void qpost_pool_s8(const int8_t *in, int8_t *out, uint16_t rows, uint16_t cols,
+                   uint16_t win_rows, uint16_t win_cols, qpost_pool_t mode);
+
+void qpost_ref_dequant_s8(const int8_t *in, int16_t *out, uint32_t n, int16_t zero_point, qpost_scale_t scale);
+void qpost_ref_clamp_s16(int16_t *data, uint32_t n, int16_t lo, int16_t hi);
+void qpost_ref_scale_s16(int16_t *data, uint32_t n, qpost_scale_t scale);
+uint32_t qpost_ref_argmax_s16(const int16_t *data, uint32_t n);
+void qpost_ref_pool_s8(const int8_t *in, int8_t *out, uint16_t rows, uint16_t cols,
+                       uint16_t win_rows, uint16_t win_cols, qpost_pool_t mode);
+
+enum { QPOST_K_DEQUANT = 0, QPOST_K_CLAMP, QPOST_K_SCALE, QPOST_K_ARGMAX, QPOST_K_POOL, QPOST_N_KERNELS };
+
+typedef struct {
+  uint32_t mismatches;                  // elements where the public kernel differs from the reference
+  float cpe[QPOST_N_KERNELS];           // [cycles/element] public kernels
+  float cpe_ref[QPOST_N_KERNELS];       // [cycles/element] reference kernels
+} qpost_bench_t;
+
+/* Run every kernel and its reference on pseudo-random data, compare and time them.
+   "cycles" reads a free-running cycle counter (DWT->CYCCNT on the Crazyflie), may be NULL. */
+uint32_t qpost_selftest(qpost_bench_t *bench, uint32_t (*cycles)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    setpoint_buffer.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ The "current desired setpoint", handed from the code that decides it
+ (maneuvers, CNN controller) to the task that streams it to the commander
+ at a fixed rate.
+
+ Lock-free double buffer with one writer and one reader: the writer fills
+ the slot the reader is not using and publishes it by bumping a sequence
+ number (release); the reader copies the slot of the sequence it loaded
+ (acquire) and retries if the writer started on that slot again meanwhile.
+ The writer never waits; the reader retries at most SETPOINT_READ_RETRIES
+ times and then returns what it copied last.
+*/
+
+#ifndef __SETPOINT_BUFFER_H
+#define __SETPOINT_BUFFER_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SETPOINT_READ_RETRIES 4
+
+typedef enum {
+  SETPOINT_IDLE = 0,      // stream nothing: the commander times out as if the app had stopped
+  SETPOINT_VELOCITY,      // x, y: body velocity [m/s], z: height [m], yaw: yaw rate [deg/s]
+  SETPOINT_POSITION,      // x, y, z: world position [m], yaw: [deg]
+} setpoint_mode_t;
+
+typedef struct {
+  uint8_t mode;           // setpoint_mode_t
+  float x, y, z, yaw;
+} setpoint_request_t;
+
+typedef struct {
+  setpoint_request_t slots[2];
+  uint32_t seq;           // requests published, the newest is in slots[seq & 1]
+  uint32_t started;       // requests the writer has started, seq or seq + 1
+  uint32_t retries;       // reader copies redone because the writer lapped them
+} setpoint_buffer_t;
+
+void setpoint_buffer_init(setpoint_buffer_t *buffer);
+/* Writer: replace the current request */
+void setpoint_buffer_write(setpoint_buffer_t *buffer, const setpoint_request_t *request);
+/* Reader: copy the current request, returns its sequence number (0: nothing written yet) */
+uint32_t setpoint_buffer_read(setpoint_buffer_t *buffer, setpoint_request_t *request);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
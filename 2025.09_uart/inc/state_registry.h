@@ -0,0 +1,89 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    state_registry.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Log and param variables read by the app, resolved once.
+
+ logGetVarId() and paramGetVarId() compare strings through the whole
+ log/param table; the app used to call them on the control path (landing,
+ spins, the link watchdog). state_registry_init() resolves every id listed
+ in state_registry.c once, at boot; afterwards reading a variable is an
+ array index. state_snapshot() fills position, velocity, attitude and ranges
+ in one pass over the ids.
+*/
+
+#ifndef __STATE_REGISTRY_H
+#define __STATE_REGISTRY_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Log variables, in the order of state_registry.c
+typedef enum {
+  STATE_X = 0,
+  STATE_Y,
+  STATE_Z,
+  STATE_VX,
+  STATE_VY,
+  STATE_VZ,
+  STATE_ROLL,
+  STATE_PITCH,
+  STATE_YAW,
+  STATE_RANGE_FRONT,
+  STATE_RANGE_BACK,
+  STATE_RANGE_LEFT,
+  STATE_RANGE_RIGHT,
+  STATE_RANGE_UP,
+  STATE_N_LOGS,
+} state_log_t;
+
+// Param variables
+typedef enum {
+  STATE_DECK_FLOW = 0,
+  STATE_DECK_MULTIRANGER,
+  STATE_N_PARAMS,
+} state_param_t;
+
+typedef struct {
+  uint64_t timestamp;     // [us]
+  float x, y, z;          // [m] world frame
+  float vx, vy, vz;       // [m/s] world frame
+  float roll, pitch, yaw; // [deg]
+  uint16_t range_front, range_back, range_left, range_right, range_up; // [mm] multiranger
+} state_snapshot_t;
+
+/* Resolve every id; returns the number of variables missing from the firmware (read as 0) */
+uint8_t state_registry_init(void);
+float state_get_float(state_log_t var);
+uint32_t state_get_uint(state_log_t var);
+uint32_t state_param_uint(state_param_t var);
+void state_snapshot(state_snapshot_t *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    tensor_rx.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Streaming reception of output tensors larger than one UART frame.
+
+ The AI-deck sends a tensor as UART_MSG_TENSOR chunks, in order, each with
+ the tensor id, a frame counter and the byte offset of its data. Shapes are
+ fixed at compile time by a tensor_schema_t, and the bytes land in a static
+ arena of TENSOR_ARENA_SIZE() that holds two copies: the tensor being
+ received and the last complete one. Rows are handed out as soon as their
+ last byte arrives, so processing can start before the tensor is complete.
+ A missing or out-of-order chunk drops the rest of that tensor.
+
+ The receiver is the single producer and the app task the single consumer:
+ progress (slot, frame, complete rows) is published in one atomic word.
+*/
+
+#ifndef __TENSOR_RX_H
+#define __TENSOR_RX_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TENSOR_BYTES(rows, cols, elem_size)   ((uint32_t)(rows) * (cols) * (elem_size))
+#define TENSOR_ARENA_SIZE(rows, cols, elem_size) (2 * TENSOR_BYTES(rows, cols, elem_size))
+
+typedef struct {
+  uint8_t id;             // tensor id of the UART_MSG_TENSOR chunks
+  uint8_t elem_size;      // [byte] 1 = int8, 2 = int16, 4 = int32
+  uint16_t rows;
+  uint16_t cols;
+} tensor_schema_t;
+
+struct tensor_rx_s;
+typedef void (*tensor_row_handler_t)(const struct tensor_rx_s *rx, uint16_t row, void *ctx);
+
+typedef struct {
+  uint32_t chunks;        // chunks accepted
+  uint32_t tensors;       // tensors complete
+  uint32_t rows;          // rows complete
+  uint32_t dropped;       // tensors abandoned after a missing or out-of-order chunk
+  uint32_t overruns;      // chunks running past the end of the tensor
+} tensor_rx_stats_t;
+
+typedef struct tensor_rx_s {
+  const tensor_schema_t *schema;
+  uint8_t *arena;             // TENSOR_ARENA_SIZE() bytes
+  uint32_t size;              // [byte] one tensor
+  uint32_t row_size;          // [byte]
+  uint32_t offset;            // [byte] next expected byte of the tensor being received
+  uint8_t frame;              // frame counter of the tensor being received
+  uint8_t slot;               // arena half being written
+  bool receiving;
+  uint32_t progress;          // published to the consumer, see tensor_rx_progress()
+  tensor_row_handler_t on_row;  // producer context, optional
+  void *ctx;
+  tensor_rx_stats_t stats;
+} tensor_rx_t;
+
+void tensor_rx_init(tensor_rx_t *rx, const tensor_schema_t *schema, uint8_t *arena,
+                    tensor_row_handler_t on_row, void *ctx);
+
+/* Producer: store one chunk. Returns false if it was dropped. */
+bool tensor_rx_chunk(tensor_rx_t *rx, uint8_t frame, uint16_t offset, const uint8_t *data, uint32_t len);
+
+/* Consumer: slot and frame of the newest tensor with complete rows, and how many. False before the first row. */
+bool tensor_rx_progress(const tensor_rx_t *rx, uint8_t *slot, uint8_t *frame, uint16_t *rows);
+
+/* Row "row" of the tensor in "slot"; stable until the producer starts the tensor after the next one. */
+const uint8_t *tensor_rx_row(const tensor_rx_t *rx, uint8_t slot, uint16_t row);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    trajectory.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Minimum-jerk trajectory segments and a settle detector, for takeoff,
+ landing and spins.
+
+ A segment goes from p0 to p1 at rest at both ends along
+   p(t) = p0 + (p1 - p0) * s(t / T),  s(u) = 10 u^3 - 15 u^4 + 6 u^5
+ whose peak speed is 1.875 |p1 - p0| / T and peak acceleration
+ 5.774 |p1 - p0| / T^2 (at u = 0.5 -/+ 0.289). The duration is the shortest
+ that keeps both within the limits, computed once at init; sampling is a
+ handful of multiplications, at any time and any rate.
+
+ Segments can also be given a fixed duration, and a linear (constant-speed)
+ profile; yaw is wrapped by the caller with traj_wrap_deg().
+
+ The settle detector ends a hold once the tracking error and the speed stay
+ within tolerance for settle_ms, or after timeout_ms.
+*/
+
+#ifndef __TRAJECTORY_H
+#define __TRAJECTORY_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRAJ_MJ_PEAK_VEL    1.875f    // peak speed of s(u) per unit distance and time
+#define TRAJ_MJ_PEAK_ACC    5.7735f   // peak acceleration of s(u), 10 / sqrt(3)
+
+typedef enum {
+  TRAJ_MIN_JERK = 0,
+  TRAJ_LINEAR,
+} traj_profile_t;
+
+typedef struct {
+  float p0;
+  float delta;            // p1 - p0
+  float duration;         // [s]
+  float inv_duration;
+  uint8_t profile;        // traj_profile_t
+} traj_segment_t;
+
+typedef struct {
+  float tolerance;        // |error| to count as settled
+  float speed_tolerance;  // |speed| to count as settled
+  uint32_t settle_ms;     // [ms] continuously within tolerance
+  uint32_t timeout_ms;    // [ms] give up and report settled anyway
+} traj_settle_config_t;
+
+typedef struct {
+  uint32_t start_ms;
+  uint32_t inside_ms;     // [ms] time the current in-tolerance streak started
+  bool inside;
+  bool timed_out;
+} traj_settle_t;
+
+/* Shortest minimum-jerk segment p0 -> p1 with peak speed <= v_max and peak acceleration <= a_max */
+void traj_segment_init(traj_segment_t *segment, float p0, float p1, float v_max, float a_max);
+/* Segment p0 -> p1 lasting exactly "duration" [s] along "profile" */
+void traj_segment_init_timed(traj_segment_t *segment, float p0, float p1, float duration, traj_profile_t profile);
+/* Position at t [s] after the start, optionally speed and acceleration; clamped outside [0, duration] */
+float traj_segment_sample(const traj_segment_t *segment, float t, float *vel, float *acc);
+
+/* Angle wrapped into [-180, 180) [deg] */
+float traj_wrap_deg(float deg);
+
+void traj_settle_start(traj_settle_t *settle, uint32_t now_ms);
+/* Feed the tracking error and speed at now_ms, true once settled (or timed out) */
+bool traj_settle_update(traj_settle_t *settle, const traj_settle_config_t *config, float error, float speed,
+                        uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
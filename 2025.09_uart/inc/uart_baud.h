@@ -0,0 +1,100 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_baud.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Runtime baud-rate negotiation of the AI-deck UART link.
+
+ Both ends boot at UART_BAUD_BASE. The Crazyflie sends UART_MSG_BAUD_REQ
+ (payload: uint32 baud rate) and the AI-deck answers UART_MSG_BAUD_ACK with
+ the same rate (or 0 to refuse) still at the old rate; then both switch.
+ At a high rate the Crazyflie repeats the request every keepalive_ms as a
+ heartbeat. The AI-deck must go back to UART_BAUD_BASE when it misses
+ UART_BAUD_KEEPALIVE_LOSS heartbeats in a row.
+
+ The Crazyflie falls back to UART_BAUD_BASE itself when the error ratio
+ (CRC errors + resyncs over received frames) of a window exceeds
+ max_error_pct, then retries with the next lower rate after holdoff_ms.
+ No firmware dependency: time and link counters are passed in by the caller.
+*/
+
+#ifndef __UART_BAUD_H
+#define __UART_BAUD_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_BAUD_BASE            115200
+#define UART_BAUD_MAX_RATES       4
+#define UART_BAUD_KEEPALIVE_LOSS  3
+
+typedef enum {
+  UART_BAUD_STATE_BASE = 0,   // at UART_BAUD_BASE, waiting to (re)try
+  UART_BAUD_STATE_REQUESTED,  // request sent, waiting for the ack
+  UART_BAUD_STATE_PROBATION,  // switched, checking the first window
+  UART_BAUD_STATE_ACTIVE,     // running at the negotiated rate
+} uart_baud_state_t;
+
+typedef struct {
+  uint32_t rates[UART_BAUD_MAX_RATES];  // candidate rates, fastest first, 0-terminated
+  uint32_t ack_timeout_ms;
+  uint32_t window_ms;                   // error-rate evaluation window (also the probation time)
+  uint32_t min_frames;                  // frames needed in a window to judge it
+  uint32_t max_error_pct;               // [%] errors / (frames + errors) that triggers the fallback
+  uint32_t keepalive_ms;
+  uint32_t holdoff_ms;                  // wait at the base rate before trying again
+} uart_baud_config_t;
+
+typedef struct {
+  void (*send_request)(uint32_t baud, void *ctx);   // send UART_MSG_BAUD_REQ at the current rate
+  void (*apply)(uint32_t baud, void *ctx);          // reconfigure the local UART
+  void *ctx;
+} uart_baud_io_t;
+
+typedef struct {
+  uart_baud_config_t config;
+  uart_baud_io_t io;
+  uart_baud_state_t state;
+  uint32_t baud;              // rate currently applied
+  uint8_t candidate;          // index in config.rates of the rate being tried / used
+  uint32_t t_state;           // [ms] time of the last state change
+  uint32_t t_keepalive;       // [ms]
+  uint32_t window_frames;     // counters at the start of the current window
+  uint32_t window_errors;
+  uint32_t fallbacks;
+  uint32_t last_error_pct;    // [%] error ratio of the last complete window
+} uart_baud_t;
+
+void uart_baud_init(uart_baud_t *neg, const uart_baud_config_t *config, const uart_baud_io_t *io);
+/* Call periodically with the current time and the cumulative frame / error counters of the link. */
+void uart_baud_step(uart_baud_t *neg, uint32_t now_ms, uint32_t frames, uint32_t errors);
+/* Call when a UART_MSG_BAUD_ACK arrives. */
+void uart_baud_on_ack(uart_baud_t *neg, uint32_t baud, uint32_t now_ms, uint32_t frames, uint32_t errors);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,72 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_channel.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Logical channels multiplexed on the AI-deck UART link by message id.
+
+ The application declares a const table of channels (id, accepted payload
+ length range, handler) and passes uart_channel_dispatch() to the frame
+ parser. Each channel gets its own frame and byte counters; frames with an
+ unknown id or an out-of-range length are counted and dropped.
+*/
+
+#ifndef __UART_CHANNEL_H
+#define __UART_CHANNEL_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include "uart_frame.h"
+
+typedef struct {
+  uint8_t msg_id;
+  uint8_t min_len;                  // [byte] accepted payload length range
+  uint8_t max_len;
+  uart_frame_handler_t handler;     // called with the dispatcher's ctx
+} uart_channel_t;
+
+typedef struct {
+  uint32_t frames;
+  uint32_t bytes;                   // payload bytes
+  uint32_t len_errors;
+} uart_channel_stats_t;
+
+typedef struct {
+  const uart_channel_t *channels;
+  uart_channel_stats_t *stats;      // one entry per channel
+  uint8_t n_channels;
+  uint32_t unknown;                 // frames with an id not in the table
+  void *ctx;
+} uart_dispatch_t;
+
+void uart_dispatch_init(uart_dispatch_t *dispatch, const uart_channel_t *channels,
+                        uart_channel_stats_t *stats, uint8_t n_channels, void *ctx);
+/* uart_frame_handler_t to give to uart_frame_parse(), ctx is the uart_dispatch_t */
+void uart_channel_dispatch(const uart_frame_t *frame, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
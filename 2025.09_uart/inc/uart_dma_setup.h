@@ -26,7 +26,36 @@
 #include "uart_dma_pulp.h"
 
 
+typedef struct {
+  uint32_t torn;    // reads that overlapped with the DMA writing the same bytes
+  uint32_t missed;  // times the DMA lapped the reader: the unread bytes were lost
+} USART_DMA_Stats;
+
+extern USART_DMA_Stats usartDmaStats;
+
+// circular mode: the DMA fills the pulpRxBuffer ring continuously
 void USART_DMA_Start(uint32_t baudrate, int8_t *pulpRxBuffer, uint32_t BUFFERSIZE);
+// double-buffer mode: the DMA alternates between two BUFFERSIZE buffers (memory 0 / memory 1)
+void USART_DMA_StartDoubleBuffer(uint32_t baudrate, int8_t *pulpRxBuffer0, int8_t *pulpRxBuffer1, uint32_t BUFFERSIZE);
 void USART_Reset_Buffer(int8_t *pulpRxBuffer);
+// change the baud rate without stopping the RX DMA, bytes in flight are lost
+void USART_DMA_SetBaudrate(uint32_t baudrate);
+// start a TX DMA transfer of len bytes; data must stay untouched until USART_DMA_TxBusy() returns 0
+TestStatus USART_DMA_Send(const uint8_t *data, uint32_t len);
+uint8_t USART_DMA_TxBusy(void);
+// to be called from the RX DMA interrupt when the transfer-complete flag is set
+void USART_DMA_RxComplete(void);
+// to be polled from a task (the USART3 vector belongs to the firmware's UART1 driver):
+// 1 (and the flag cleared) if the line went idle after a burst
+uint8_t USART_DMA_RxIdle(void);
+
+// Both modes deliver every byte written so far, including a partly filled buffer,
+// whatever the frame boundaries.
+// copy up to maxLen bytes received since the last call
+uint32_t USART_DMA_Read(uint8_t *dst, uint32_t maxLen);
+// zero-copy: the unread bytes up to the end of the current buffer (0 if none). Consume
+// reports FAILED (and counts a torn read) if the DMA overwrote them before the consumer was done.
+uint32_t USART_DMA_Peek(const uint8_t **data);
+TestStatus USART_DMA_Consume(uint32_t n);
 
 #endif
@@ -0,0 +1,193 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_frame.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Framing layer of the AI-deck <-> Crazyflie UART link.
+
+ Wire format (multi-byte fields are little-endian):
+
+   | 0xA5 | 0x5A | len | msg_id | seq | payload[len] | crc16 lo | crc16 hi |
+
+ The CRC is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) computed over
+ len, msg_id, seq and the payload. The parser is byte-oriented and does not
+ depend on the firmware, so it also builds on a Linux host.
+ After a corrupted or dropped byte it locks again on the next sync word, at
+ most UART_FRAME_MAX_SIZE bytes later.
+*/
+
+#ifndef __UART_FRAME_H
+#define __UART_FRAME_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_FRAME_SYNC0          0xA5
+#define UART_FRAME_SYNC1          0x5A
+#define UART_FRAME_HEADER_SIZE    5     // sync0, sync1, len, msg_id, seq
+#define UART_FRAME_CRC_SIZE       2
+#define UART_FRAME_MAX_PAYLOAD    64    // [byte]
+#define UART_FRAME_OVERHEAD       (UART_FRAME_HEADER_SIZE + UART_FRAME_CRC_SIZE)
+#define UART_FRAME_MAX_SIZE       (UART_FRAME_OVERHEAD + UART_FRAME_MAX_PAYLOAD)
+
+// Message ids
+#define UART_MSG_INFERENCE        0x01  // CNN outputs: int32 steering, int32 collision
+#define UART_MSG_INFERENCE_Q8     0x02  // CNN outputs: int8 each, dequantized with the last UART_MSG_QUANT_HEADER
+#define UART_MSG_INFERENCE_Q16    0x03  // CNN outputs: int16 each, dequantized with the last UART_MSG_QUANT_HEADER
+#define UART_MSG_QUANT_HEADER     0x04  // AI-deck -> Crazyflie: uart_quant_msg_t, shared by the following Q8/Q16 frames
+#define UART_MSG_TENSOR           0x05  // AI-deck -> Crazyflie: uart_tensor_chunk_t + tensor bytes, see tensor_rx.h
+#define UART_MSG_QUANT_TABLE      0x06  // AI-deck -> Crazyflie: uart_quant_table_msg_t, per-output scale and zero point
+#define UART_MSG_NET_COMMAND      0x07  // AI-deck -> Crazyflie: uart_net_command_msg_t, result of one auxiliary network (see fusion.h)
+#define UART_MSG_BAUD_REQ         0x10  // Crazyflie -> AI-deck: uint32 baud rate (see uart_baud.h)
+#define UART_MSG_BAUD_ACK         0x11  // AI-deck -> Crazyflie: uint32 accepted baud rate, 0 if refused
+#define UART_MSG_STATE            0x20  // Crazyflie -> AI-deck: uart_state_msg_t
+#define UART_MSG_LINK_STATS       0x21  // Crazyflie -> AI-deck: uart_link_stats_msg_t, once per second
+#define UART_MSG_DEBUG_TEXT       0x30  // AI-deck -> Crazyflie: ASCII text, not null-terminated
+#define UART_MSG_CONFIG_ACK       0x31  // AI-deck -> Crazyflie: uint8 config id, uint8 status (0 = ok)
+#define UART_MSG_TIMING_PROBE     0x32  // both ways: uart_timing_msg_t, echoed by the Crazyflie
+
+typedef struct {
+  uint8_t msg_id;
+  uint8_t seq;
+  uint8_t len;
+  uint8_t payload[UART_FRAME_MAX_PAYLOAD];
+} uart_frame_t;
+
+typedef struct {
+  uint32_t frames;        // valid frames delivered
+  uint32_t crc_errors;    // frames dropped because of a CRC mismatch
+  uint32_t len_errors;    // headers with a length above UART_FRAME_MAX_PAYLOAD
+  uint32_t resyncs;       // number of times the parser lost the stream and had to hunt for a sync word
+  uint32_t bytes_dropped; // bytes discarded while hunting
+  uint32_t seq_gaps;      // frames missing according to the sequence number
+} uart_frame_stats_t;
+
+// UART_MSG_STATE payload: state-estimate snapshot streamed to the AI-deck
+typedef struct __attribute__((packed)) {
+  uint32_t timestamp;   // [ms]
+  float vx, vy, vz;     // [m/s] world frame
+  float z;              // [m] height
+  float yaw;            // [deg]
+  uint16_t range_front, range_back, range_left, range_right, range_up; // [mm] multiranger
+} uart_state_msg_t;
+
+// UART_MSG_LINK_STATS payload: receiver-side counters, cumulative since boot
+typedef struct __attribute__((packed)) {
+  uint32_t frames;
+  uint32_t crc_errors;
+  uint32_t resyncs;
+  uint32_t bytes_dropped;
+  uint32_t seq_gaps;
+  uint32_t queue_overflows;
+  uint32_t latency_max;  // [us] DMA interrupt -> app task
+} uart_link_stats_msg_t;
+
+// UART_MSG_TIMING_PROBE payload: the AI-deck fills t_deck, the Crazyflie echoes it with t_rx and t_tx
+typedef struct __attribute__((packed)) {
+  uint32_t t_deck;      // [us] AI-deck clock when the probe was sent
+  uint32_t t_rx;        // [us] Crazyflie clock at the DMA interrupt
+  uint32_t t_tx;        // [us] Crazyflie clock when the echo was queued
+} uart_timing_msg_t;
+
+/*
+ UART_MSG_QUANT_HEADER payload: output = (q - zero_point) * scale, for every output.
+ Compact frames carry only the quantized values, so the header is sent once
+ and then again whenever it changes; the AI-deck also repeats it about once
+ per second so a rebooted Crazyflie picks it up.
+*/
+typedef struct __attribute__((packed)) {
+  float scale;
+  int16_t zero_point;
+} uart_quant_msg_t;
+
+/*
+ UART_MSG_QUANT_TABLE payload: scale and zero point of outputs first ..
+ first + n - 1, where n follows from the payload length. It overrides
+ UART_MSG_QUANT_HEADER for those outputs and applies to every inference
+ format. Sent at boot and repeated like the header.
+*/
+typedef struct __attribute__((packed)) {
+  uint8_t first;
+  uart_quant_msg_t entries[];
+} uart_quant_table_msg_t;
+
+#define UART_QUANT_TABLE_MAX ((UART_FRAME_MAX_PAYLOAD - sizeof(uart_quant_table_msg_t)) / sizeof(uart_quant_msg_t))
+
+/*
+ UART_MSG_NET_COMMAND payload: the command proposed by one of the networks
+ running next to DroNet (e.g. gate or person detection), fused on the
+ Crazyflie with the other results. latency_ms lets the receiver date the
+ result back to the camera frame it was computed on.
+*/
+typedef struct __attribute__((packed)) {
+  uint8_t net_id;       // fusion source, 1..FUSION_MAX_SOURCES-1 (0 is DroNet)
+  uint8_t confidence;   // 255 = 1.0
+  int16_t steering;     // Q15, [-1, 1], positive turns left
+  uint16_t speed;       // 65535 = 1.0, fraction of the maximum forward speed allowed
+  uint16_t latency_ms;  // [ms] camera frame -> frame sent
+} uart_net_command_msg_t;
+
+// UART_MSG_TENSOR payload header, followed by up to UART_TENSOR_CHUNK_MAX bytes of the tensor
+typedef struct __attribute__((packed)) {
+  uint8_t tensor_id;
+  uint8_t frame;        // tensor counter, the same for every chunk of one tensor
+  uint16_t offset;      // [byte] position of the chunk data in the tensor
+} uart_tensor_chunk_t;
+
+#define UART_TENSOR_CHUNK_MAX (UART_FRAME_MAX_PAYLOAD - sizeof(uart_tensor_chunk_t))
+
+typedef void (*uart_frame_handler_t)(const uart_frame_t *frame, void *ctx);
+
+typedef struct {
+  uint8_t buf[UART_FRAME_MAX_SIZE]; // bytes of the frame being assembled, buf[0] is always a sync candidate
+  uint32_t len;
+  uint8_t last_seq;
+  bool has_seq;
+  bool hunting;
+  uart_frame_t frame;
+  uart_frame_stats_t stats;
+} uart_frame_parser_t;
+
+void uart_frame_parser_init(uart_frame_parser_t *parser);
+
+/* Feed "len" received bytes; "handler" is called once per valid frame, in order. */
+void uart_frame_parse(uart_frame_parser_t *parser, const uint8_t *data, uint32_t len,
+                      uart_frame_handler_t handler, void *ctx);
+
+/* Serialize one frame into "out". Returns the number of bytes written, 0 if it does not fit. */
+uint32_t uart_frame_encode(uint8_t *out, uint32_t out_size, uint8_t msg_id, uint8_t seq,
+                           const uint8_t *payload, uint8_t len);
+
+/* Widen the values of a UART_MSG_INFERENCE[_Q8|_Q16] payload into "out".
+   Returns the number of values, 0 for any other message or a partial value. */
+uint8_t uart_frame_unpack_outputs(const uart_frame_t *frame, int32_t *out, uint8_t max_outputs);
+
+uint16_t uart_frame_crc16(uint16_t crc, const uint8_t *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,78 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_tx.h
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+/*
+ Non-blocking transmit queue of the AI-deck UART link.
+
+ Frames are encoded straight into one of two batch buffers. uart_tx_poll()
+ hands the filled batch to the DMA as soon as the previous transfer is done
+ and keeps filling the other one, so the caller never waits on the UART.
+ Frames that do not fit in the free batch are dropped and counted.
+ The hardware is reached through two callbacks, so this builds on a host too.
+*/
+
+#ifndef __UART_TX_H
+#define __UART_TX_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_TX_BATCH_SIZE  128   // [byte] per batch buffer
+
+typedef struct {
+  bool (*start)(const uint8_t *data, uint32_t len, void *ctx);  // false if the DMA is still busy
+  bool (*busy)(void *ctx);
+  void *ctx;
+} uart_tx_io_t;
+
+typedef struct {
+  uint8_t batch[2][UART_TX_BATCH_SIZE];
+  uint32_t fill_len;          // bytes waiting in batch[fill_idx]
+  uint32_t flight_len;        // bytes handed to the DMA
+  uint8_t fill_idx;
+  uint8_t seq;
+  uart_tx_io_t io;
+  // statistics
+  uint32_t frames_queued;
+  uint32_t frames_dropped;
+  uint32_t bytes_sent;
+  uint32_t depth;             // [byte] queued + in flight, updated by uart_tx_poll()
+  uint32_t bytes_per_sec;     // measured over the last second
+  uint32_t t_window;          // [ms]
+  uint32_t window_bytes;
+} uart_tx_t;
+
+void uart_tx_init(uart_tx_t *tx, const uart_tx_io_t *io);
+/* Encode and queue one frame. Returns false (and counts a drop) if the batch is full. */
+bool uart_tx_frame(uart_tx_t *tx, uint8_t msg_id, const void *payload, uint8_t len);
+/* Start the next DMA transfer if possible and update the statistics. Never blocks. */
+void uart_tx_poll(uart_tx_t *tx, uint32_t now_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
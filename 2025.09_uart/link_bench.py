@@ -0,0 +1,108 @@
+"""Throughput benchmark of the framed UART link at several baud rates.
+
+Sends back-to-back inference frames and parses them on the receiving side
+with the same rules as the firmware, then reports sustained frames per
+second and error rate for each rate and inference frame format; compact
+quantized frames are compared against the int32 format.
+
+  python link_bench.py --tx /dev/ttyUSB0               # TX wired to RX on the same adapter
+  python link_bench.py --tx /dev/ttyUSB0 --rx /dev/ttyUSB1
+  python link_bench.py --pty                           # no hardware: host parser ceiling only
+"""
+import argparse
+import os
+import struct
+import threading
+import time
+import tty
+
+from uart_frame import pack_inference, FrameParser, INFERENCE_FORMATS, BAUD_BASE, OVERHEAD
+
+RATES = [BAUD_BASE, 1000000, 2000000, 3000000]
+
+
+def open_ports(args, baud):
+    if args.pty:
+        master, slave = os.openpty()
+        tty.setraw(slave)  # no line discipline: bytes pass unchanged
+        writer = os.fdopen(master, "wb", buffering=0)
+        reader = os.fdopen(slave, "rb", buffering=0)
+        return writer, reader
+    import serial
+    tx = serial.Serial(args.tx, baud, timeout=0.05)
+    rx = serial.Serial(args.rx, baud, timeout=0.05) if args.rx else tx
+    return tx, rx
+
+
+def frame_size(fmt, outputs):
+    return OVERHEAD + outputs * struct.calcsize(INFERENCE_FORMATS[fmt][1])
+
+
+def run(args, baud, fmt):
+    writer, reader = open_ports(args, baud)
+    parser = FrameParser()
+    values = [0.5] * args.outputs
+    sent = [0, 0]  # frames, bytes
+    stop = threading.Event()
+
+    def send():
+        seq = 0
+        while not stop.is_set():
+            frame = pack_inference(fmt, seq, values, 0.01)
+            writer.write(frame)
+            sent[0] += 1
+            sent[1] += len(frame)
+            seq += 1
+
+    thread = threading.Thread(target=send, daemon=True)
+    t_start = time.time()
+    thread.start()
+    received = 0
+    while time.time() - t_start < args.duration:
+        data = reader.read(4096)
+        if data:
+            received += len(parser.feed(data))
+    stop.set()
+    thread.join()
+    elapsed = time.time() - t_start
+    writer.close()
+    if reader is not writer:
+        reader.close()
+
+    size = frame_size(fmt, args.outputs)
+    errors = parser.crc_errors + parser.resyncs
+    return {
+        "baud": baud,
+        "format": fmt,
+        "bytes": size,
+        "saved": frame_size("int32", args.outputs) - size,
+        "fps": received / elapsed,
+        "max_fps": baud / 10 / size,  # 8N1: 10 bits per byte
+        "kbps": received * size / elapsed / 1000,
+        "error_pct": 100.0 * errors / max(received + errors, 1),
+        "lost_pct": 100.0 * parser.seq_gaps / max(received + parser.seq_gaps, 1),
+    }
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--tx", default="/dev/ttyUSB0")
+    p.add_argument("--rx", default=None, help="receiving port, default: loopback on --tx")
+    p.add_argument("--pty", action="store_true", help="use a pseudo-terminal pair instead of hardware")
+    p.add_argument("--rates", type=int, nargs="+", default=RATES)
+    p.add_argument("--formats", nargs="+", choices=sorted(INFERENCE_FORMATS), default=["int32", "q16", "q8"])
+    p.add_argument("--outputs", type=int, default=2, help="CNN outputs per frame")
+    p.add_argument("--duration", type=float, default=3.0, help="[s] per rate")
+    args = p.parse_args()
+
+    print(f"{'baud':>9} {'format':>6} {'B/frame':>8} {'saved':>6} {'frames/s':>10} {'max f/s':>10} {'kB/s':>8} "
+          f"{'errors %':>9} {'lost %':>8}")
+    for baud in args.rates:
+        for fmt in args.formats:
+            r = run(args, baud, fmt)
+            print(f"{r['baud']:>9} {r['format']:>6} {r['bytes']:>8} {r['saved']:>6} {r['fps']:>10.0f} "
+                  f"{r['max_fps']:>10.0f} {r['kbps']:>8.1f} {r['error_pct']:>9.2f} {r['lost_pct']:>8.2f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,277 @@
+"""Traffic generator and stress tester for the AI-deck UART link.
+
+Plays the AI-deck side: sends framed inference results at a configurable
+rate, payload schema and burst pattern, optionally injects byte drops, bit
+flips and stalls, and reports what the receiver says it got
+(UART_MSG_LINK_STATS) plus the round-trip time of timing probes.
+It also answers the Crazyflie's baud-rate requests (see inc/uart_baud.h).
+
+  python link_tester.py                                  # Crazyflie on /dev/ttyUSB0
+  python link_tester.py --port /dev/pts/5 --drop 1e-3     # host receiver (host/link_rx.c)
+  python link_tester.py --rate 100 --burst 5 --burst-period 0.5 --flip 1e-4
+  python link_tester.py --format q8 --scale 0.008     # compact frames + quantization header
+  python link_tester.py --format q8 --channel-quant 0.008:0,0.004:-100  # per-output quantization table
+  python link_tester.py --tensor 8x8 --tensor-rate 15  # chunked int8 depth grids
+  python link_tester.py --net 1:10:40 --net 2:5:120      # auxiliary networks for the fusion stage
+"""
+import argparse
+import math
+import os
+import random
+import struct
+import subprocess
+import time
+
+from uart_frame import (pack_frame, pack_inference, pack_tensor, pack_quant_table, pack_net_command, FrameParser,
+                        MSG_INFERENCE, MSG_BAUD_REQ, MSG_BAUD_ACK, MSG_STATE, MSG_LINK_STATS, MSG_TIMING_PROBE,
+                        MSG_QUANT_HEADER, STATE_FORMAT, LINK_STATS_FORMAT, TIMING_FORMAT, QUANT_FORMAT,
+                        INFERENCE_FORMATS, BAUD_BASE)
+
+KEEPALIVE_TIMEOUT = 0.75    # [s] 3 missed heartbeats -> back to the base rate
+SCHEMA_TYPES = {"i8": "b", "u8": "B", "i16": "h", "u16": "H", "i32": "i", "u32": "I", "f32": "f"}
+
+
+def check_usb_device(port="/dev/ttyUSB0"):
+    print(f"Checking for {port} ...")
+
+    # 1️⃣ Check if the device exists
+    if not os.path.exists(port):
+        print(f"[ERROR] {port} not found.")
+        print("Recent dmesg logs:")
+        subprocess.run("dmesg | tail", shell=True)
+        return False
+
+    print(f"[OK] {port} detected.")
+    return True
+
+
+def now_us():
+    return int(time.monotonic() * 1e6) & 0xFFFFFFFF
+
+
+class Injector:
+    """Corrupts the outgoing byte stream."""
+
+    def __init__(self, drop, flip, delay_prob, delay_ms):
+        self.drop, self.flip = drop, flip
+        self.delay_prob, self.delay_ms = delay_prob, delay_ms
+        self.dropped = self.flipped = self.delayed = 0
+
+    def write(self, ser, frame):
+        data = bytearray()
+        for byte in frame:
+            if self.drop and random.random() < self.drop:
+                self.dropped += 1
+                continue
+            if self.flip and random.random() < self.flip:
+                byte ^= 1 << random.randrange(8)
+                self.flipped += 1
+            data.append(byte)
+        if self.delay_prob and random.random() < self.delay_prob:
+            # stall in the middle of the frame
+            cut = random.randrange(len(data) + 1)
+            ser.write(bytes(data[:cut]))
+            ser.flush()
+            time.sleep(self.delay_ms / 1000)
+            data = data[cut:]
+            self.delayed += 1
+        ser.write(bytes(data))
+
+
+class Stats:
+    def __init__(self):
+        self.sent = self.sent_bytes = 0
+        self.tensor_bytes = 0
+        self.link = None          # last UART_MSG_LINK_STATS
+        self.link_prev = None
+        self.rtt = []             # [us]
+        self.states = 0
+
+
+def make_payload(schema, seq):
+    values = [(seq * (i + 1)) if c != "f" else seq * (i + 1) * 0.001 for i, c in enumerate(schema)]
+    packed = []
+    for c, v in zip(schema, values):
+        if c in "bh":
+            bits = 8 * struct.calcsize(c) - 1
+            v = (v + (1 << bits)) % (1 << (bits + 1)) - (1 << bits)
+        elif c in "BHI":
+            v %= 1 << (8 * struct.calcsize(c))
+        elif c == "i":
+            v = (v + (1 << 31)) % (1 << 32) - (1 << 31)
+        packed.append(v)
+    return struct.pack("<" + schema, *packed)
+
+
+def cnn_outputs(seq):
+    """Plausible DroNet outputs: steering sweeping [-1, 1], collision ramping [0, 1]."""
+    return [math.sin(seq * 0.05), (seq % 100) / 100.0]
+
+
+def net_command(net_id, seq):
+    """Auxiliary network result: steering towards a wandering target, a stop request now and then."""
+    return math.sin(seq * 0.1 + net_id), 0.0 if seq % 20 < 3 else 1.0, 0.8
+
+
+def depth_grid(frame, rows, cols):
+    """int8 grid with a moving obstacle."""
+    return bytes(((10 if (r + c + frame) % 7 == 0 else 100) for r in range(rows) for c in range(cols)))
+
+
+def handle_rx(ser, parser, stats, state, args):
+    for msg_id, _, payload in parser.feed(ser.read(ser.in_waiting or 1)):
+        if msg_id == MSG_BAUD_REQ and len(payload) == 4:
+            (baud,) = struct.unpack("<I", payload)
+            state["last_request"] = time.time()
+            accepted = baud if args.accept_baud else 0
+            ser.write(pack_frame(MSG_BAUD_ACK, state["seq"], struct.pack("<I", accepted)))
+            state["seq"] += 1
+            if accepted and accepted != ser.baudrate:
+                ser.flush()
+                ser.baudrate = accepted
+                print(f"Switched to {accepted} baud.")
+        elif msg_id == MSG_LINK_STATS and len(payload) == struct.calcsize(LINK_STATS_FORMAT):
+            stats.link = struct.unpack(LINK_STATS_FORMAT, payload)
+        elif msg_id == MSG_TIMING_PROBE and len(payload) == struct.calcsize(TIMING_FORMAT):
+            t_deck, _, _ = struct.unpack(TIMING_FORMAT, payload)
+            stats.rtt.append((now_us() - t_deck) & 0xFFFFFFFF)
+        elif msg_id == MSG_STATE and len(payload) == struct.calcsize(STATE_FORMAT):
+            stats.states += 1
+            if args.verbose:
+                print("state:", struct.unpack(STATE_FORMAT, payload))
+
+
+def report(stats, injector, elapsed, window):
+    line = f"[{elapsed:6.1f}s] tx {stats.sent:7d} fr {(stats.sent_bytes + stats.tensor_bytes) / max(elapsed, 1e-3):8.0f} B/s"
+    line += f" {stats.sent_bytes / max(stats.sent, 1):4.1f} B/fr"
+    line += f" | inj drop {injector.dropped} flip {injector.flipped} stall {injector.delayed}"
+    if stats.link:
+        frames, crc, resyncs, dropped, gaps, q_ovf, lat_max = stats.link
+        prev = stats.link_prev or (0,) * len(stats.link)
+        line += (f" | rx {frames} ({(frames - prev[0]) / window:.0f} fr/s) crc {crc} resync {resyncs}"
+                 f" gaps {gaps} q_ovf {q_ovf} lat_max {lat_max} us")
+        stats.link_prev = stats.link
+    if stats.rtt:
+        line += f" | rtt min {min(stats.rtt) / 1000:.2f} avg {sum(stats.rtt) / len(stats.rtt) / 1000:.2f}"
+        line += f" max {max(stats.rtt) / 1000:.2f} ms"
+        stats.rtt = []
+    print(line)
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("--port", default="/dev/ttyUSB0", help="serial port or pty of host/link_rx")
+    p.add_argument("--baud", type=int, default=BAUD_BASE)
+    p.add_argument("--rate", type=float, default=30.0, help="[frames/s] steady rate")
+    p.add_argument("--schema", default="i32,i32", help="payload fields: " + ",".join(SCHEMA_TYPES))
+    p.add_argument("--msg-id", type=lambda x: int(x, 0), default=MSG_INFERENCE)
+    p.add_argument("--format", choices=sorted(INFERENCE_FORMATS), default=None,
+                   help="send synthetic CNN outputs in this format instead of --schema/--msg-id")
+    p.add_argument("--scale", type=float, default=0.0006, help="quantization scale of --format")
+    p.add_argument("--zero-point", type=int, default=0, help="quantization zero point of --format")
+    p.add_argument("--channel-quant", default=None,
+                   help="SCALE:ZERO per output, comma-separated: sent as a quantization table instead of the header")
+    p.add_argument("--tensor", default=None, help="ROWSxCOLS int8 tensor sent as UART_MSG_TENSOR chunks")
+    p.add_argument("--tensor-rate", type=float, default=10.0, help="[tensors/s]")
+    p.add_argument("--tensor-id", type=int, default=0)
+    p.add_argument("--net", action="append", default=[],
+                   help="ID:RATE[:LATENCY_MS] auxiliary network sending UART_MSG_NET_COMMAND, repeatable")
+    p.add_argument("--burst", type=int, default=0, help="frames sent back-to-back every --burst-period")
+    p.add_argument("--burst-period", type=float, default=1.0, help="[s]")
+    p.add_argument("--drop", type=float, default=0.0, help="probability of dropping each byte")
+    p.add_argument("--flip", type=float, default=0.0, help="probability of flipping a bit in each byte")
+    p.add_argument("--delay", type=float, default=0.0, help="probability of stalling inside a frame")
+    p.add_argument("--delay-ms", type=float, default=20.0, help="[ms] stall duration")
+    p.add_argument("--probe-rate", type=float, default=2.0, help="[Hz] timing probes, 0 = off")
+    p.add_argument("--duration", type=float, default=0.0, help="[s] 0 = run forever")
+    p.add_argument("--no-accept-baud", dest="accept_baud", action="store_false",
+                   help="refuse the Crazyflie's high-speed requests")
+    p.add_argument("--verbose", action="store_true")
+    args = p.parse_args()
+
+    import serial
+    check_usb_device(args.port)
+    ser = serial.Serial(args.port, args.baud, timeout=0)
+    print(f"Opened serial port {args.port} at {args.baud} baud.")
+
+    schema = "".join(SCHEMA_TYPES[f.strip()] for f in args.schema.split(","))
+    injector = Injector(args.drop, args.flip, args.delay, args.delay_ms)
+    parser = FrameParser()
+    stats = Stats()
+    state = {"seq": 0, "last_request": time.time()}
+
+    t_start = time.time()
+    t_frame = t_burst = t_probe = t_report = t_start
+    t_quant = t_start if args.format else None
+    if args.channel_quant:
+        channel_quant = [(float(s), int(z)) for s, z in (e.split(":") for e in args.channel_quant.split(","))]
+        scale, zero_point = [s for s, _ in channel_quant], [z for _, z in channel_quant]
+    else:
+        channel_quant, scale, zero_point = None, args.scale, args.zero_point
+    t_tensor, tensor_frame = t_start, 0
+    tensor_shape = tuple(int(x) for x in args.tensor.split("x")) if args.tensor else None
+    nets = []  # [net_id, period, latency_ms, next send, results sent]
+    for spec in args.net:
+        fields = spec.split(":")
+        nets.append([int(fields[0]), 1.0 / float(fields[1]), int(fields[2]) if len(fields) > 2 else 0, t_start, 0])
+    while not args.duration or time.time() - t_start < args.duration:
+        now = time.time()
+        n_frames = 0
+        if args.rate and now >= t_frame:
+            n_frames += 1
+            t_frame += 1.0 / args.rate
+        if args.burst and now >= t_burst:
+            n_frames += args.burst
+            t_burst += args.burst_period
+        if t_quant is not None and now >= t_quant:
+            # quantization of the outputs, repeated so a rebooted receiver picks it up
+            if channel_quant:
+                ser.write(pack_quant_table(state["seq"], channel_quant))
+            else:
+                ser.write(pack_frame(MSG_QUANT_HEADER, state["seq"], struct.pack(QUANT_FORMAT, args.scale, args.zero_point)))
+            state["seq"] += 1
+            t_quant += 1.0
+        for _ in range(n_frames):
+            if args.format:
+                frame = pack_inference(args.format, state["seq"], cnn_outputs(state["seq"]), scale, zero_point)
+            else:
+                frame = pack_frame(args.msg_id, state["seq"], make_payload(schema, state["seq"]))
+            injector.write(ser, frame)
+            state["seq"] += 1
+            stats.sent += 1
+            stats.sent_bytes += len(frame)
+        if tensor_shape and now >= t_tensor:
+            frames, state["seq"] = pack_tensor(args.tensor_id, tensor_frame, depth_grid(tensor_frame, *tensor_shape),
+                                               state["seq"])
+            for frame in frames:
+                injector.write(ser, frame)
+                stats.tensor_bytes += len(frame)
+            tensor_frame += 1
+            t_tensor += 1.0 / args.tensor_rate
+        for net in nets:
+            if now >= net[3]:
+                steering, speed, confidence = net_command(net[0], net[4])
+                injector.write(ser, pack_net_command(state["seq"], net[0], steering, speed, confidence, net[2]))
+                state["seq"] += 1
+                net[3] += net[1]
+                net[4] += 1
+        if args.probe_rate and now >= t_probe:
+            ser.write(pack_frame(MSG_TIMING_PROBE, state["seq"], struct.pack(TIMING_FORMAT, now_us(), 0, 0)))
+            state["seq"] += 1
+            t_probe += 1.0 / args.probe_rate
+
+        handle_rx(ser, parser, stats, state, args)
+        if ser.baudrate != BAUD_BASE and time.time() - state["last_request"] > KEEPALIVE_TIMEOUT:
+            ser.baudrate = BAUD_BASE
+            print(f"Heartbeat lost, back to {BAUD_BASE} baud.")
+
+        if now - t_report >= 1.0:
+            report(stats, injector, now - t_start, now - t_report)
+            t_report = now
+        time.sleep(0.0005)
+
+    ser.close()
+
+
+if __name__ == "__main__":
+    main()
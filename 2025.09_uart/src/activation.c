@@ -0,0 +1,125 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    activation.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <string.h>
+#include "activation.h"
+
+#define LOG2E       1.442695041f
+#define EXP2_MIN    -126.0f     // smallest normal power of two
+#define EXP2_MAX    127.0f
+#define LUT_BITS    6
+#define LUT_SIZE    (1 << LUT_BITS)
+
+// 2^(i / 64), i = 0..64
+static const float exp2_lut[LUT_SIZE + 1] = {
+  1.000000000f, 1.010889286f, 1.021897149f, 1.033024879f, 1.044273782f,
+  1.055645178f, 1.067140401f, 1.078760798f, 1.090507733f, 1.102382583f,
+  1.114386743f, 1.126521619f, 1.138788635f, 1.151189230f, 1.163724859f,
+  1.176396992f, 1.189207115f, 1.202156731f, 1.215247360f, 1.228480536f,
+  1.241857812f, 1.255380757f, 1.269050957f, 1.282870016f, 1.296839555f,
+  1.310961212f, 1.325236643f, 1.339667524f, 1.354255547f, 1.369002423f,
+  1.383909882f, 1.398979673f, 1.414213562f, 1.429613338f, 1.445180807f,
+  1.460917794f, 1.476826146f, 1.492907728f, 1.509164428f, 1.525598151f,
+  1.542210825f, 1.559004400f, 1.575980845f, 1.593142151f, 1.610490332f,
+  1.628027422f, 1.645755478f, 1.663676580f, 1.681792831f, 1.700106354f,
+  1.718619298f, 1.737333835f, 1.756252160f, 1.775376493f, 1.794709075f,
+  1.814252176f, 1.834008086f, 1.853979125f, 1.874167634f, 1.894575982f,
+  1.915206561f, 1.936061793f, 1.957144124f, 1.978456026f, 2.000000000f,
+};
+
+// 2^k for an integer k in [-126, 127], built directly in the exponent field
+static inline float pow2i(int32_t k)
+{
+  uint32_t bits = (uint32_t)(k + 127) << 23;
+  float result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+// 2^f for f in [-0.5, 0.5], minimax for the relative error (7.5e-8 in exact arithmetic)
+static inline float exp2_poly(float f)
+{
+  return 1.000000119e+00f + f * (6.931469440e-01f + f * (2.402212024e-01f + f * (5.550713092e-02f
+         + f * (9.675540961e-03f + f * 1.327647245e-03f))));
+}
+
+float act_exp2(float x, act_tier_t tier)
+{
+  if (tier == ACT_LIBM) {
+    return exp2f(x);
+  }
+  if (x < EXP2_MIN) return 0.0f;
+  if (x > EXP2_MAX) x = EXP2_MAX;
+
+  if (tier == ACT_POLY) {
+    int32_t k = (int32_t)(x + (x >= 0.0f ? 0.5f : -0.5f));  // nearest integer
+    return exp2_poly(x - (float)k) * pow2i(k);
+  }
+  int32_t k = (int32_t)x;                                   // floor
+  if ((float)k > x) k--;
+  float position = (x - (float)k) * LUT_SIZE;
+  int32_t i = (int32_t)position;
+  if (i >= LUT_SIZE) i = LUT_SIZE - 1;
+  float frac = position - (float)i;
+  return (exp2_lut[i] + frac * (exp2_lut[i + 1] - exp2_lut[i])) * pow2i(k);
+}
+
+float act_exp(float x, act_tier_t tier)
+{
+  if (tier == ACT_LIBM) {
+    return expf(x);
+  }
+  return act_exp2(x * LOG2E, tier);
+}
+
+float act_sigmoid(float x, act_tier_t tier)
+{
+  return 1.0f / (1.0f + act_exp(-x, tier));
+}
+
+float act_tanh(float x, act_tier_t tier)
+{
+  if (tier == ACT_LIBM) {
+    return tanhf(x);
+  }
+  return 2.0f * act_sigmoid(2.0f * x, tier) - 1.0f;
+}
+
+void act_softmax(const float *in, float *out, uint32_t n, act_tier_t tier)
+{
+  if (n == 0) return;
+  float max = in[0];
+  for (uint32_t i = 1; i < n; i++) {
+    if (in[i] > max) max = in[i];
+  }
+  // every exponent is <= 0: no overflow, and the largest term is exactly 1
+  float sum = 0.0f;
+  for (uint32_t i = 0; i < n; i++) {
+    out[i] = act_exp(in[i] - max, tier);
+    sum += out[i];
+  }
+  float inv = 1.0f / sum;
+  for (uint32_t i = 0; i < n; i++) {
+    out[i] *= inv;
+  }
+}
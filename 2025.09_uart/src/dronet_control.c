@@ -0,0 +1,56 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    dronet_control.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "dronet_control.h"
+
+void dronet_control_reset(dronet_control_t *control)
+{
+  memset(control, 0, sizeof(dronet_control_t));
+}
+
+static float clampf(float x, float lo, float hi)
+{
+  return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// 0 up to the dead-band, then linear up to 1
+static float deadband(float x, float band)
+{
+  if (band <= 0.0f) return x;
+  if (band >= 1.0f || x <= band) return 0.0f;
+  return (x - band) / (1.0f - band);
+}
+
+void dronet_control_step(const dronet_control_config_t *config, dronet_control_t *control,
+                         float steering, float collision)
+{
+  float p = deadband(clampf(collision, 0.0f, 1.0f), config->coll_deadband);
+  float s = clampf(steering, -1.0f, 1.0f);
+  s = s < 0.0f ? -deadband(-s, config->steer_deadband) : deadband(s, config->steer_deadband);
+
+  float a_speed = clampf(config->alpha_speed, 0.0f, 1.0f);
+  float a_yaw = clampf(config->alpha_yaw, 0.0f, 1.0f);
+  control->speed += a_speed * ((1.0f - p) * config->max_speed - control->speed);
+  control->yaw_rate += a_yaw * (s * config->max_yaw_rate - control->yaw_rate);
+  control->steps++;
+}
@@ -0,0 +1,123 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    filter_bank.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "filter_bank.h"
+
+#define TWO_PI  6.283185307f
+
+void filter_reset(filter_state_t *state)
+{
+  memset(state, 0, sizeof(filter_state_t));
+}
+
+// smoothing factor of a first-order low-pass with cutoff fc [Hz] over dt [s]
+static float lowpass_alpha(float fc, float dt)
+{
+  float tau = 1.0f / (TWO_PI * fc);
+  return dt / (tau + dt);
+}
+
+static float ema(const filter_config_t *config, filter_state_t *state, float x, float dt)
+{
+  float alpha = config->alpha;
+  if (alpha <= 0.0f || alpha >= 1.0f) {
+    return state->y = x;
+  }
+  // the time constant that gives "alpha" at the nominal period, applied to the actual dt
+  float tau = FILTER_NOMINAL_DT * (1.0f - alpha) / alpha;
+  state->y += dt / (tau + dt) * (x - state->y);
+  return state->y;
+}
+
+static float median(const filter_config_t *config, filter_state_t *state, float x)
+{
+  uint8_t n = config->median_n;
+  if (n < 1) n = 1;
+  if (n > FILTER_MEDIAN_MAX) n = FILTER_MEDIAN_MAX;
+
+  state->window[state->head] = x;
+  state->head = (uint8_t)((state->head + 1) % n);
+  if (state->count < n) state->count++;
+
+  // insertion sort of a copy, n is small
+  float sorted[FILTER_MEDIAN_MAX];
+  for (uint8_t i = 0; i < state->count; i++) {
+    float v = state->window[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > v) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = v;
+  }
+  uint8_t mid = state->count / 2;
+  state->y = (state->count & 1) ? sorted[mid] : 0.5f * (sorted[mid - 1] + sorted[mid]);
+  return state->y;
+}
+
+static float one_euro(const filter_config_t *config, filter_state_t *state, float x, float dt)
+{
+  float dx = (x - state->x_prev) / dt;
+  state->x_prev = x;
+  state->dx += lowpass_alpha(config->d_cutoff, dt) * (dx - state->dx);
+  float cutoff = config->min_cutoff + config->beta * (state->dx < 0 ? -state->dx : state->dx);
+  state->y += lowpass_alpha(cutoff, dt) * (x - state->y);
+  return state->y;
+}
+
+static float kalman(const filter_config_t *config, filter_state_t *state, float x, float dt)
+{
+  state->p += config->q * dt;
+  float k = state->p / (state->p + config->r);
+  state->y += k * (x - state->y);
+  state->p *= 1.0f - k;
+  return state->y;
+}
+
+float filter_update(const filter_config_t *config, filter_state_t *state, float x, uint32_t t_us)
+{
+  uint32_t dt_us = t_us - state->last_us;
+  if (!state->init || state->type != config->type || dt_us > FILTER_MAX_GAP_US ||
+      (config->type == FILTER_MEDIAN && (state->count > config->median_n || state->head >= config->median_n))) {
+    // (re)start from this sample
+    filter_reset(state);
+    state->init = true;
+    state->type = config->type;
+    state->last_us = t_us;
+    state->y = x;
+    state->x_prev = x;
+    state->p = config->r;
+    if (config->type == FILTER_MEDIAN) median(config, state, x);
+    return x;
+  }
+  state->last_us = t_us;
+  float dt = dt_us > 0 ? dt_us * 1e-6f : 1e-6f;
+
+  switch (config->type) {
+    case FILTER_EMA:      return ema(config, state, x, dt);
+    case FILTER_MEDIAN:   return median(config, state, x);
+    case FILTER_ONE_EURO: return one_euro(config, state, x, dt);
+    case FILTER_KALMAN:   return kalman(config, state, x, dt);
+    default:              return state->y = x;
+  }
+}
@@ -0,0 +1,115 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    fusion.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "fusion.h"
+
+void fusion_init(fusion_t *fusion)
+{
+  memset(fusion, 0, sizeof(fusion_t));
+}
+
+void fusion_publish(fusion_t *fusion, uint8_t source, uint32_t t_us, const fusion_command_t *command)
+{
+  if (source >= FUSION_MAX_SOURCES) {
+    return;
+  }
+  fusion_slot_t *slot = &fusion->slots[source];
+  uint32_t seq = slot->seq;
+  // odd: the consumer retries until the result is complete
+  __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  slot->t_us = t_us;
+  slot->command = *command;
+  __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+  fusion->published[source]++;
+}
+
+// Copy a slot consistently; false if it is empty or kept changing under the reader
+static bool slot_read(fusion_slot_t *slot, uint32_t *t_us, fusion_command_t *command)
+{
+  for (int i = 0; i < FUSION_READ_RETRIES; i++) {
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) continue;
+    *t_us = slot->t_us;
+    *command = slot->command;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+      return seq != 0;
+    }
+  }
+  return false;
+}
+
+static float clampf(float x, float lo, float hi)
+{
+  return x < lo ? lo : (x > hi ? hi : x);
+}
+
+bool fusion_tick(fusion_t *fusion, uint32_t now_us, fusion_output_t *out)
+{
+  float w_sum = 0.0f, w_enabled = 0.0f, steering = 0.0f, speed = 1.0f;
+  bool valid = true;
+  memset(out, 0, sizeof(fusion_output_t));
+  fusion->ticks++;
+
+  for (uint8_t i = 0; i < FUSION_MAX_SOURCES; i++) {
+    const fusion_source_config_t *config = &fusion->config[i];
+    if (!config->enable) continue;
+    w_enabled += config->weight;
+
+    uint32_t t_us;
+    fusion_command_t command;
+    bool fresh = false;
+    if (slot_read(&fusion->slots[i], &t_us, &command)) {
+      int32_t age = (int32_t)(now_us - t_us);
+      if (age < 0) age = 0;  // stamped after "now" by a producer that preempted the consumer
+      if ((uint32_t)age <= config->max_age_us && config->max_age_us > 0) {
+        fresh = true;
+        float confidence = clampf(command.confidence, 0.0f, 1.0f);
+        float w = config->weight * confidence * (1.0f - (float)age / (float)config->max_age_us);
+        steering += w * clampf(command.steering, -1.0f, 1.0f);
+        w_sum += w;
+        float limit = 1.0f - confidence * (1.0f - clampf(command.speed, 0.0f, 1.0f));
+        if (limit < speed) speed = limit;
+        if (out->used == 0 || (int32_t)(t_us - out->t_newest_us) > 0) out->t_newest_us = t_us;
+        if ((uint32_t)age > out->age_max_us) out->age_max_us = age;
+        out->used |= 1u << i;
+        fusion->used[i]++;
+      } else {
+        fusion->rejected[i]++;
+      }
+    } else if (fusion->slots[i].seq != 0) {
+      fusion->torn++;
+    }
+    if (config->required && !fresh) valid = false;
+  }
+
+  if (!valid || out->used == 0) {
+    fusion->invalid++;
+    return out->valid = false;
+  }
+  out->command.steering = w_sum > 0.0f ? steering / w_sum : 0.0f;
+  out->command.speed = speed;
+  out->command.confidence = w_enabled > 0.0f ? w_sum / w_enabled : 0.0f;
+  return out->valid = true;
+}
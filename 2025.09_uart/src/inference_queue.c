@@ -0,0 +1,71 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    inference_queue.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "inference_queue.h"
+
+#define INFERENCE_QUEUE_MASK (INFERENCE_QUEUE_SIZE - 1)
+
+_Static_assert((INFERENCE_QUEUE_SIZE & INFERENCE_QUEUE_MASK) == 0, "INFERENCE_QUEUE_SIZE must be a power of two");
+
+void inference_queue_init(inference_queue_t *queue)
+{
+  memset(queue, 0, sizeof(inference_queue_t));
+}
+
+bool inference_queue_push(inference_queue_t *queue, const inference_record_t *record)
+{
+  uint32_t head = queue->head;
+  uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+  uint32_t depth = head - tail;
+
+  if (depth >= INFERENCE_QUEUE_SIZE) {
+    queue->overflows++;
+    return false;
+  }
+  queue->records[head & INFERENCE_QUEUE_MASK] = *record;
+  // the record must be visible before the consumer sees the new head
+  __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+
+  queue->pushed++;
+  if (depth + 1 > queue->high_water) queue->high_water = depth + 1;
+  return true;
+}
+
+bool inference_queue_pop(inference_queue_t *queue, inference_record_t *record)
+{
+  uint32_t tail = queue->tail;
+  uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+
+  if (head == tail) {
+    return false;
+  }
+  *record = queue->records[tail & INFERENCE_QUEUE_MASK];
+  // release the slot only after the record was copied out
+  __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+uint32_t inference_queue_count(const inference_queue_t *queue)
+{
+  return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+}
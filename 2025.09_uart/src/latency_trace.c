@@ -0,0 +1,115 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    latency_trace.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "latency_trace.h"
+
+#define TRACE_HIST_MIN_LOG2   4
+
+static uint32_t hist_bin(uint32_t cycles)
+{
+  if (cycles < (1u << TRACE_HIST_MIN_LOG2)) return 0;
+  uint32_t octave = 31 - __builtin_clz(cycles);
+  // the two bits below the leading one select the sub-bucket
+  uint32_t sub = (cycles >> (octave - 2)) & (TRACE_HIST_SUB - 1);
+  uint32_t bin = (octave - TRACE_HIST_MIN_LOG2) * TRACE_HIST_SUB + sub;
+  return bin < TRACE_HIST_BINS ? bin : TRACE_HIST_BINS - 1;
+}
+
+// Upper edge of a bin [cycles]
+static uint32_t hist_edge(uint32_t bin)
+{
+  uint32_t octave = bin / TRACE_HIST_SUB + TRACE_HIST_MIN_LOG2;
+  uint32_t sub = bin % TRACE_HIST_SUB;
+  return (1u << octave) + ((sub + 1) << (octave - 2));
+}
+
+static void stats_add(trace_stats_t *stats, uint32_t cycles, float cycles_per_us)
+{
+  uint32_t bin = hist_bin(cycles);
+  if (stats->hist[bin] == UINT16_MAX) {
+    // keep the shape, forget half of the history
+    for (uint32_t i = 0; i < TRACE_HIST_BINS; i++) stats->hist[i] >>= 1;
+  }
+  stats->hist[bin]++;
+
+  if (stats->count == 0 || cycles < stats->min) stats->min = cycles;
+  stats->count++;
+  stats->sum += cycles;
+
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < TRACE_HIST_BINS; i++) total += stats->hist[i];
+  uint32_t target = total - total / 100;
+  uint32_t cumulated = 0;
+  uint32_t p99_bin = 0;
+  for (p99_bin = 0; p99_bin < TRACE_HIST_BINS; p99_bin++) {
+    cumulated += stats->hist[p99_bin];
+    if (cumulated >= target) break;
+  }
+
+  stats->min_us = stats->min / cycles_per_us;
+  stats->mean_us = (float)(stats->sum / stats->count) / cycles_per_us;
+  stats->p99_us = hist_edge(p99_bin) / cycles_per_us;
+}
+
+void latency_trace_init(latency_trace_t *trace, float cycles_per_us)
+{
+  memset(trace, 0, sizeof(latency_trace_t));
+  trace->cycles_per_us = cycles_per_us;
+}
+
+void latency_trace_begin(latency_trace_t *trace, uint8_t seq, uint32_t t_irq, uint32_t t_decode, uint32_t t_postproc)
+{
+  uint32_t pending_seq = trace->pending_seq + 1;
+  __atomic_store_n(&trace->pending_started, pending_seq, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  trace->pending.seq = seq;
+  trace->pending.t[TRACE_IRQ] = t_irq;
+  trace->pending.t[TRACE_DECODE] = t_decode;
+  trace->pending.t[TRACE_POSTPROC] = t_postproc;
+  __atomic_store_n(&trace->pending_seq, pending_seq, __ATOMIC_RELEASE);
+}
+
+void latency_trace_setpoint(latency_trace_t *trace, uint32_t t_setpoint)
+{
+  uint32_t pending_seq = __atomic_load_n(&trace->pending_seq, __ATOMIC_ACQUIRE);
+  if (pending_seq == trace->taken_seq) return;
+  trace_entry_t pending = trace->pending;
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&trace->pending_started, __ATOMIC_RELAXED) != pending_seq) {
+    return;  // the writer is replacing it: close the newer trace at the next setpoint
+  }
+  trace->taken_seq = pending_seq;
+
+  trace_entry_t *entry = &trace->ring[trace->head % TRACE_RING_SIZE];
+  *entry = pending;
+  entry->t[TRACE_SETPOINT] = t_setpoint;
+  trace->head++;
+
+  // unsigned differences stay correct across a counter wrap
+  const uint32_t *t = entry->t;
+  float k = trace->cycles_per_us;
+  stats_add(&trace->stats[TRACE_STAGE_DECODE], t[TRACE_DECODE] - t[TRACE_IRQ], k);
+  stats_add(&trace->stats[TRACE_STAGE_POSTPROC], t[TRACE_POSTPROC] - t[TRACE_DECODE], k);
+  stats_add(&trace->stats[TRACE_STAGE_SETPOINT], t[TRACE_SETPOINT] - t[TRACE_POSTPROC], k);
+  stats_add(&trace->stats[TRACE_STAGE_TOTAL], t[TRACE_SETPOINT] - t[TRACE_IRQ], k);
+}
@@ -0,0 +1,112 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    link_health.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "link_health.h"
+
+#define JITTER_GAIN   (1.0f / 16.0f)
+
+void link_health_init(link_health_t *health, uint32_t now_us)
+{
+  memset(health, 0, sizeof(link_health_t));
+  health->last_us = now_us;
+  health->window_start_us = now_us;
+}
+
+void link_health_frame(link_health_t *health, uint32_t now_us)
+{
+  uint32_t dt = now_us - health->last_us;
+  if (health->frames > 0) {
+    if (dt > health->gap_max_us) health->gap_max_us = dt;
+    if (health->frames == 1) {
+      health->period_us = (float)dt;
+    }
+    float deviation = (float)dt - health->period_us;
+    health->period_us += JITTER_GAIN * deviation;
+    health->jitter_us += JITTER_GAIN * ((deviation < 0 ? -deviation : deviation) - health->jitter_us);
+  }
+  // last_us last: the app task reads it without a lock to compute the age
+  health->frames++;
+  __atomic_store_n(&health->last_us, now_us, __ATOMIC_RELEASE);
+}
+
+void link_health_window(link_health_t *health, uint32_t now_us, uint32_t window_us, uint32_t errors)
+{
+  uint32_t elapsed = now_us - health->window_start_us;
+  if (elapsed < window_us) {
+    return;
+  }
+  uint32_t frames = __atomic_load_n(&health->frames, __ATOMIC_RELAXED);
+  health->rate_hz = (float)(frames - health->window_frames) * 1e6f / (float)elapsed;
+  health->error_rate_hz = (float)(errors - health->window_errors) * 1e6f / (float)elapsed;
+  health->window_frames = frames;
+  health->window_errors = errors;
+  health->window_start_us = now_us;
+}
+
+uint32_t link_health_age_us(const link_health_t *health, uint32_t now_us)
+{
+  uint32_t last_us = __atomic_load_n(&health->last_us, __ATOMIC_ACQUIRE);
+  // a frame stamped after now_us was sampled (interrupt or preemption in between) is 0 old, not 71 minutes;
+  // only a short window though, a silence longer than 2^31 us is still a silence
+  if (last_us - now_us <= LINK_SKEW_US) {
+    return 0;
+  }
+  return now_us - last_us;
+}
+
+void link_watchdog_init(link_watchdog_t *wd, const link_watchdog_config_t *config)
+{
+  memset(wd, 0, sizeof(link_watchdog_t));
+  wd->config = *config;
+}
+
+void link_watchdog_arm(link_watchdog_t *wd, uint32_t now_ms)
+{
+  wd->armed_ms = now_ms;
+  wd->level = LINK_OK;
+}
+
+link_level_t link_watchdog_step(link_watchdog_t *wd, uint32_t now_ms, uint32_t age_ms)
+{
+  if (wd->level == LINK_LAND) {
+    return LINK_LAND;
+  }
+  // a link that was silent before arming only counts from the arming time
+  if (age_ms > now_ms - wd->armed_ms) {
+    age_ms = now_ms - wd->armed_ms;
+  }
+
+  link_level_t level = LINK_OK;
+  if (age_ms >= wd->config.land_ms) {
+    level = LINK_LAND;
+  } else if (age_ms >= wd->config.hover_ms) {
+    level = LINK_HOVER;
+  } else if (age_ms >= wd->config.slow_ms) {
+    level = LINK_SLOW;
+  }
+  if (level != wd->level) {
+    wd->trips[level]++;
+    wd->level = level;
+  }
+  return level;
+}
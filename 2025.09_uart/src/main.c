@@ -41,21 +41,142 @@
 #include "commander.h"
 #include "log.h"
 #include "param.h"
+#include "usec_time.h"
 // my headers
 #include "config_main.h"
 #include "main.h"
 // uncomment to use DMA for UART communication with AI-deck
 #include "uart_dma_setup.h"
-
-#define BUFFERSIZE 8 // [byte] size of the RX buffer for UART-DMA
+#include "uart_frame.h"
+#include "inference_queue.h"
+#include "uart_baud.h"
+#include "uart_tx.h"
+#include "uart_channel.h"
+#include "latency_trace.h"
+#include "tensor_rx.h"
+#include "link_health.h"
+#include "qpost.h"
+#include "activation.h"
+#include "networks.h"
+#include "filter_bank.h"
+#include "dronet_control.h"
+#include "fusion.h"
+#include "setpoint_buffer.h"
+#include "trajectory.h"
+#include "path.h"
+#include "state_registry.h"
+#include "maneuver.h"
+
+#define CNN_OUTPUTS 2  // values carried by an inference frame
+enum { CNN_STEERING = 0, CNN_COLLISION = 1 };
+dronet_output_t dronet_output; 	// decoded by process_cnn_output()
+_Static_assert(dronet_BYTES == 4*CNN_OUTPUTS, "DroNet decoder does not match the inference frame");
+// RX DMA buffers, independent of the frame sizes: every interrupt (transfer complete, half
+// transfer, IDLE line) hands the parser whatever bytes arrived, frames may straddle buffers
+#if UART_RX_DOUBLE_BUFFER
+#define BUFFERSIZE UART_RX_BUFFER_SIZE // [byte] per DMA buffer
+int8_t pulpRxBuffer[2][BUFFERSIZE];
+#else
+#define BUFFERSIZE (2*UART_RX_BUFFER_SIZE) // [byte] circular RX ring, interrupt at each half
 int8_t pulpRxBuffer[BUFFERSIZE];
-uint8_t dma_flag = 0;
-int32_t cnn_data_int[BUFFERSIZE/4];
-float cnn_data_float[BUFFERSIZE/4];
-float nemo_quantum = 0.0006;
+#endif
+int32_t cnn_data_int[CNN_OUTPUTS];
+float cnn_data_float[CNN_OUTPUTS];
+float cnn_filtered[CNN_OUTPUTS]; 	// cnn_data_float after the temporal filters
+#define FILTER_DEFAULTS(filter_type) { .type = filter_type, .alpha = FILTER_ALPHA, .median_n = FILTER_MEDIAN_N, \
+	.min_cutoff = FILTER_MIN_CUTOFF, .beta = FILTER_BETA, .d_cutoff = FILTER_D_CUTOFF, .q = FILTER_KF_Q, .r = FILTER_KF_R }
+filter_config_t filter_config[CNN_OUTPUTS] = { 	// GUI parameters
+	[CNN_STEERING] = FILTER_DEFAULTS(FILTER_STEERING),
+	[CNN_COLLISION] = FILTER_DEFAULTS(FILTER_COLLISION),
+};
+filter_state_t filter_state[CNN_OUTPUTS];
+// Dequantization of each CNN output (DECODE_RUNTIME_SCALE heads of DRONET_HEADS), written by
+// UART_MSG_QUANT_TABLE / UART_MSG_QUANT_HEADER frames and by the QUANT_PAR params
+decode_quant_t quant_table[CNN_OUTPUTS] = {
+	[CNN_STEERING] = { .scale = NEMO_QUANTUM, .zero_point = 0 },
+	[CNN_COLLISION] = { .scale = NEMO_QUANTUM, .zero_point = 0 },
+};
+_Static_assert(dronet_HEADS == CNN_OUTPUTS, "one quantization entry per DroNet head");
+uint32_t quant_saturated[CNN_OUTPUTS]; 	// received values at the limit of their wire type
+uint32_t quant_table_errors = 0; 	// UART_MSG_QUANT_TABLE frames naming unknown outputs
+uart_frame_parser_t uart_parser;
+uart_dispatch_t uart_dispatch;
+uint32_t uart_rx_timestamp; 		// [us] DMA interrupt time of the bytes being parsed
+uint32_t uart_rx_cycles; 			// [cycles] DMA interrupt entry, for latency tracing
+latency_trace_t latency_trace;		// IRQ -> decode -> post-processing -> setpoint
+volatile uint8_t uart_wakeup = 0;	// set by channel handlers that need the app task
+inference_queue_t inference_queue;	// DMA interrupt -> app task
+TaskHandle_t inference_task = NULL;	// consumer woken by the DMA interrupt
+
+// Fixed-point post-processing kernels, checked against their C reference and timed at boot
+qpost_bench_t qpost_bench;
+
+// Inference stream health and failsafe
+link_health_t link_health;
+link_watchdog_t link_watchdog;
+uint8_t wd_enable = WATCHDOG_ENABLE; 	// GUI parameter
+float wd_slow_factor = WATCHDOG_SLOW_FACTOR;
+uint32_t link_age_ms = 0; 			// [ms] since the last inference frame, logged
+state_snapshot_t hover_pos; 		// position and yaw held while LINK_HOVER
+
+// Output tensors streamed by the GAP9, shapes fixed at compile time
+enum { TENSOR_DEPTH = 0, N_TENSORS };
+#define TENSOR_NONE 0xFFFF
+const tensor_schema_t tensor_schemas[N_TENSORS] = {
+	[TENSOR_DEPTH] = { .id = 0, .elem_size = 1, .rows = DEPTH_GRID_ROWS, .cols = DEPTH_GRID_COLS },
+};
+uint8_t depth_arena[TENSOR_ARENA_SIZE(DEPTH_GRID_ROWS, DEPTH_GRID_COLS, 1)];
+tensor_rx_t tensor_rx[N_TENSORS];
+uint16_t tensor_frame[N_TENSORS]; 	// consumer side: frame counter of the tensor being processed, TENSOR_NONE before the first
+uint16_t tensor_rows_done[N_TENSORS];
+uint32_t tensor_rows_skipped = 0; 	// rows overwritten before the app task got to them
+int8_t depth_row_min[DEPTH_GRID_ROWS]; // closest value of each row of the last depth grid
+int8_t depth_min = 0; 				// closest value of the last complete depth grid
+depth_output_t depth_output; 		// last complete depth grid [m]
+float depth_near = 0.0f; 			// [m] closest point of depth_output
+_Static_assert(depth_BYTES == TENSOR_BYTES(DEPTH_GRID_ROWS, DEPTH_GRID_COLS, 1), "depth decoder does not match the tensor schema");
+
+// Debug text from the GAP9, printed by the app task
+#define DEBUG_TEXT_SIZE 64
+char debug_text[DEBUG_TEXT_SIZE];
+volatile uint8_t debug_text_len = 0;
+uint32_t debug_text_dropped = 0; 	// lines received while the previous one was not printed yet
+
+// Last configuration acknowledgement from the AI-deck
+uint8_t config_ack_id = 0;
+uint8_t config_ack_status = 0;
+
+// Timing probe from the AI-deck, echoed back with the Crazyflie timestamps
+uart_timing_msg_t timing_probe;
+volatile uint8_t timing_probe_new = 0;
+
+// Baud-rate negotiation with the AI-deck
+uart_baud_t uart_baud;
+volatile uint32_t baud_ack_value = 0;
+volatile uint8_t baud_ack_new = 0;		// set by the DMA interrupt
+uint32_t uart_baudrate = UART_BAUD_BASE; // [baud] logged
+
+// State stream to the AI-deck
+uart_tx_t uart_tx;
+uint16_t state_rate = STATE_STREAM_RATE; // [Hz] GUI parameter, 0 = off
+uint32_t state_t_last = 0; 	// [ms]
+
+// Log/param ids resolved once (state_registry.h), cost of a read by name against a cached one
+uint8_t state_missing = 0; 		// variables the firmware does not have
+#define STATE_BENCH_RUNS 32 		// repetitions of each measurement: the first one runs from cold caches
+enum { STATE_BENCH_NAME = 0, STATE_BENCH_ID, STATE_BENCH_SNAP, STATE_BENCH_N };
+uint32_t state_bench_min[STATE_BENCH_N]; 	// [cycles] yaw read by logGetVarId() + logGetFloat(), by state_get_float(), state_snapshot()
+uint32_t state_bench_mean[STATE_BENCH_N]; 	// [cycles]
+
+// Latency from DMA interrupt to processing in the app task, bins of x4 width: [0,16) [16,64) ... [16384,inf) us
+#define LATENCY_BINS 8
+uint32_t latency_hist[LATENCY_BINS];
+uint32_t latency_last = 0; 	// [us]
+uint32_t latency_max = 0; 	// [us]
 
 /* --------------- DEFINES --------------- */
 #define PI 3.1415926f
+#define CYCLES() (DWT->CYCCNT)		// free-running CPU cycle counter
 
 /* --------------- GUI PARAMETERS --------------- */
 
@@ -65,14 +186,69 @@ uint8_t fly = 0; 		// Takeoff/landing command (GUI parameter)
 uint8_t debug = 0; 		// activate debug prints
 
 // Global variables for the parameters
-float forward_vel 	= FORWARD_VELOCITY;
+dronet_control_config_t control_config = {
+	.max_speed = FORWARD_VELOCITY, .max_yaw_rate = CONTROL_MAX_YAW_RATE,
+	.steer_deadband = CONTROL_STEER_DB, .coll_deadband = CONTROL_COLL_DB,
+	.alpha_speed = CONTROL_ALPHA_SPEED, .alpha_yaw = CONTROL_ALPHA_YAW,
+};
 float flying_height = TARGET_H;
 
+// DroNet control law: commands updated by the UART task once per frame, applied by the flight loop
+dronet_control_t control;
+uint8_t control_enable = CONTROL_ENABLE;
+float control_rate_hz = 0.0f; 		// control updates per second
+uint32_t control_lat_us = 0; 		// [us] DMA interrupt -> control output, last frame
+uint32_t control_lat_max = 0; 		// [us]
+uint32_t control_window_us = 0; 	// rate measurement window
+uint32_t control_window_steps = 0;
+
+// Setpoint streaming: maneuvers and the flight loop write the desired setpoint, setpoint_task sends it
+setpoint_buffer_t setpoint_buffer;
+uint16_t setpoint_rate = SETPOINT_RATE; 	// [Hz] requested (GUI parameter)
+link_health_t setpoint_health; 		// actual publish rate, period, jitter and longest gap
+
+// Takeoff and landing trajectories
+float traj_takeoff_vel = TRAJ_TAKEOFF_VEL; 	// [m/s] GUI parameters
+float traj_landing_vel = TRAJ_LANDING_VEL; 	// [m/s]
+float traj_max_acc = TRAJ_MAX_ACC; 		// [m/s^2]
+float traj_landing_acc = TRAJ_LANDING_ACC; 	// [m/s^2]
+traj_settle_config_t traj_settle_config = {
+	.tolerance = TRAJ_SETTLE_TOL, .speed_tolerance = TRAJ_SETTLE_SPEED,
+	.settle_ms = TRAJ_SETTLE_MS, .timeout_ms = TRAJ_SETTLE_TIMEOUT_MS,
+};
+traj_settle_config_t traj_landing_config = {
+	.tolerance = TRAJ_LANDING_TOL, .speed_tolerance = TRAJ_LANDING_SPEED,
+	.settle_ms = TRAJ_LANDING_MS, .timeout_ms = TRAJ_LANDING_TIMEOUT_MS,
+};
+uint32_t takeoff_ms = 0; 			// [ms] last takeoff, climb and hold
+uint32_t landing_ms = 0; 			// [ms] last landing, descent and hold
+uint8_t takeoff_timeout = 0; 		// the last hold ended on its timeout, not settled
+uint8_t landing_timeout = 0;
+
+// Latest result of every network, fused into the input of the control law
+#define FUSION_DRONET 0 			// fusion source of the UART_MSG_INFERENCE[_Q8|_Q16] frames
+fusion_t fusion;
+fusion_output_t fused;
+volatile uint8_t fusion_new = 0; 	// a source published since the last fusion tick
+uint32_t net_command_errors = 0; 	// UART_MSG_NET_COMMAND frames with an unknown net_id
+
 // Manouver: Spin -- parameters
 float spin_time 		= SPIN_TIME; 			// [ms]
 float spin_yawrate 		= SPIN_YAW_RATE; 		// [deg/s]
 float spin_angle 		= SPIN_ANGLE; 			// [deg]
 float max_rand_angle 	= RANDOM_SPIN_ANGLE; 	// [deg]
+uint32_t spin_ms = 0; 			// [ms] last spin, logged
+uint32_t spin_writes = 0; 		// setpoints written by the last spin
+uint32_t spin_cycles = 0; 		// app-task CPU cycles spent computing and writing them
+
+// Manouver: Path -- parameters (path.h)
+uint8_t path_type 		= PATH_TYPE;
+float path_size 		= PATH_SIZE; 			// [m]
+float path_speed 		= PATH_SPEED; 			// [m/s]
+uint8_t path_sides 		= PATH_SIDES;
+uint8_t path_laps 		= PATH_LAPS;
+path_t path; 									// arc-length table of the last path flown
+uint32_t path_build_us = 0; 					// [us] time spent by path_init()
 
 // Demo: Manouvers -- 1=Active, 0=Non active
 uint8_t circle = 0;
@@ -85,6 +261,24 @@ uint8_t spin_drone_random = 0;
 uint8_t landed = 1; 	// Flag for indicating whether the drone landed
 
 /* ---------------    STRUCTURES    --------------- */
+// Manoeuvres run by the executor, one at a time (maneuver.h)
+enum { MANEUVER_NONE = 0, MANEUVER_PATH, MANEUVER_SPIN_T, MANEUVER_SPIN_YR };
+
+// State of the running manoeuvre, kept across executor steps
+typedef struct {
+	state_snapshot_t start; 	// position and yaw at the first step
+	float distance; 			// [m] path: length to fly
+	traj_segment_t yaw; 		// spin_t_c: yaw profile
+	float angle; 				// [deg] spin
+	float yaw_rate; 			// [deg/s] spin_yr_c
+	uint32_t duration_ms; 		// [ms] spin
+	uint32_t writes; 			// setpoints written
+	uint32_t cycles; 			// app-task cycles spent on them
+} maneuver_run_t;
+
+maneuver_executor_t maneuvers;
+maneuver_run_t maneuver_run;
+uint32_t maneuver_step_max = 0; 	// [cycles] longest executor step
 
 
 /* -------------- FUNCTION DEFINITION -------------- */
@@ -94,7 +288,6 @@ void headToVelocity(float x_vel, float y_vel, float z_pos, float yaw_rate);
 void headToPosition(float x, float y, float z, float yaw);
 setpoint_t create_velocity_setpoint(float x_vel, float y_vel, float z_pos, float yaw_rate);
 setpoint_t create_position_setpoint(float x, float y, float z, float yaw);
-// float low_pass_filtering(float data_new, float data_old, float alpha);
 
 /* ----------------------------------------------------------------------- */
 /* ------------------------------ FUNCTIONS ------------------------------ */
@@ -114,15 +307,16 @@ setpoint_t create_velocity_setpoint(float x_vel, float y_vel, float z_pos, float
     setpoint.velocity.x 	= x_vel;
     setpoint.velocity.y 	= y_vel;
     setpoint.position.z 	= z_pos;
-    setpoint.attitude.yaw 	= yaw_rate;
+    setpoint.attitudeRate.yaw 	= yaw_rate; 	// modeVelocity reads the yaw rate from attitudeRate
     setpoint.velocity_body 	= true;
 	return setpoint;
 }
 
+// Only updates the desired setpoint, setpoint_task() streams it
 void headToVelocity(float x_vel, float y_vel, float z_pos, float yaw_rate)
 {
-    fly_setpoint = create_velocity_setpoint(x_vel, y_vel, z_pos, yaw_rate);
-    commanderSetSetpoint(&fly_setpoint, 3);
+    setpoint_request_t request = { .mode = SETPOINT_VELOCITY, .x = x_vel, .y = y_vel, .z = z_pos, .yaw = yaw_rate };
+    setpoint_buffer_write(&setpoint_buffer, &request);
 }
 
 setpoint_t create_position_setpoint(float x, float y, float z, float yaw)
@@ -142,62 +336,188 @@ setpoint_t create_position_setpoint(float x, float y, float z, float yaw)
 
 void headToPosition(float x, float y, float z, float yaw)
 {
-    fly_setpoint = create_position_setpoint(x, y, z, yaw);
-	commanderSetSetpoint(&fly_setpoint, 3);
+    setpoint_request_t request = { .mode = SETPOINT_POSITION, .x = x, .y = y, .z = z, .yaw = yaw };
+    setpoint_buffer_write(&setpoint_buffer, &request);
+}
+
+// Stop streaming: the commander times out and stops the motors, as when the app sends nothing
+void setpoint_release(void)
+{
+    setpoint_request_t request = { .mode = SETPOINT_IDLE };
+    setpoint_buffer_write(&setpoint_buffer, &request);
+}
+
+// Setpoint period, at least 1 ms whatever SETPOINT/rate is set to
+uint32_t setpoint_period_ms(void)
+{
+	uint32_t period = 1000 / (setpoint_rate > 0 ? setpoint_rate : 1);
+	return period > 0 ? period : 1;
+}
+
+// Setpoint period in ticks, never 0 (vTaskDelayUntil would assert or starve the lower priority tasks)
+TickType_t setpoint_period_ticks(void)
+{
+	TickType_t ticks = M2T(setpoint_period_ms());
+	return ticks > 0 ? ticks : 1;
+}
+
+// Streams the desired setpoint at setpoint_rate, whatever the pace of its writers
+void setpoint_task(void *param)
+{
+	setpoint_request_t request;
+	uint32_t last_seq = 0;
+	TickType_t wake = xTaskGetTickCount();
+
+	while (1) {
+		vTaskDelayUntil(&wake, setpoint_period_ticks());
+		uint32_t seq = setpoint_buffer_read(&setpoint_buffer, &request);
+		if (request.mode == SETPOINT_IDLE) continue;
+
+		if (request.mode == SETPOINT_VELOCITY) {
+			fly_setpoint = create_velocity_setpoint(request.x, request.y, request.z, request.yaw);
+		} else {
+			fly_setpoint = create_position_setpoint(request.x, request.y, request.z, request.yaw);
+		}
+		commanderSetSetpoint(&fly_setpoint, 3);
+		if (seq != last_seq) {
+			// first time this request reaches the commander
+			latency_trace_setpoint(&latency_trace, CYCLES());
+			last_seq = seq;
+		}
+		uint32_t now = (uint32_t)usecTimestamp();
+		link_health_frame(&setpoint_health, now);
+		link_health_window(&setpoint_health, now, 1000000, 0);
+	}
 }
 
 
 /* --------------- Takeoff and Landing --------------- */
 
+// Follow a vertical segment, one sample per setpoint period, holding x, y and yaw
+void follow_height(const traj_segment_t *segment, float x, float y, float yaw)
+{
+	TickType_t start = xTaskGetTickCount();
+	TickType_t wake = start;
+	float t = 0.0f;
+	while (t < segment->duration) {
+		headToPosition(x, y, traj_segment_sample(segment, t, NULL, NULL), yaw);
+		vTaskDelayUntil(&wake, setpoint_period_ticks());
+		t = T2M(xTaskGetTickCount() - start) / 1000.0f;
+	}
+	headToPosition(x, y, segment->p0 + segment->delta, yaw);
+}
+
 void takeoff(float height)
 {
 	// init Kalman estimator before taking off
 	estimatorKalmanInit();
+	TickType_t start = xTaskGetTickCount();
 
 	point_t pos;
 	memset(&pos, 0, sizeof(pos));
 	estimatorKalmanGetEstimatedPos(&pos);
 
-	// first step: taking off gradually, from a starting height of 0.2 to the desired height
-	int endheight = (int)(100*(height-0.2f));
-	for(int i=0; i<endheight; i++)
-	{
-		headToPosition(pos.x, pos.y, 0.2f + (float)i / 100.0f, 0);
-		vTaskDelay(50);
-	}
-	// keep constant height
-	for(int i=0; i<100; i++)
-	{
-		headToPosition(pos.x, pos.y, height, 0);
-		vTaskDelay(50);
+	// minimum-jerk climb from the ground to the desired height
+	traj_segment_t segment;
+	traj_segment_init(&segment, pos.z > 0.0f ? pos.z : 0.0f, height, traj_takeoff_vel, traj_max_acc);
+	follow_height(&segment, pos.x, pos.y, 0);
+
+	// keep constant height until the estimate settles
+	traj_settle_t settle;
+	TickType_t wake = xTaskGetTickCount();
+	traj_settle_start(&settle, T2M(wake));
+	while (!traj_settle_update(&settle, &traj_settle_config, state_get_float(STATE_Z) - height, state_get_float(STATE_VZ),
+			T2M(xTaskGetTickCount()))) {
+		vTaskDelayUntil(&wake, setpoint_period_ticks());
 	}
+	takeoff_timeout = settle.timed_out;
+	takeoff_ms = T2M(xTaskGetTickCount() - start);
+	if (debug==1) DEBUG_PRINT("Takeoff: %lu ms, segment %.2f s%s\n", takeoff_ms, (double)segment.duration, settle.timed_out ? ", hold timed out" : "");
 }
 
 
 void land(void)
 {
-	point_t pos;
-	memset(&pos, 0, sizeof(pos));
-	estimatorKalmanGetEstimatedPos(&pos);
+	TickType_t start = xTaskGetTickCount();
+	state_snapshot_t state;
+	state_snapshot(&state);
+
+	// minimum-jerk descent, the drone drops from FINAL_LANDING_HEIGHT
+	traj_segment_t segment;
+	traj_segment_init(&segment, state.z, FINAL_LANDING_HEIGHT, traj_landing_vel, traj_landing_acc);
+	follow_height(&segment, state.x, state.y, state.yaw);
+
+	// the height loop lags the segment: hold until the drone is down there, instead of a fixed 200 ms
+	traj_settle_t settle;
+	TickType_t wake = xTaskGetTickCount();
+	traj_settle_start(&settle, T2M(wake));
+	while (!traj_settle_update(&settle, &traj_landing_config, state_get_float(STATE_Z) - FINAL_LANDING_HEIGHT,
+			state_get_float(STATE_VZ), T2M(xTaskGetTickCount()))) {
+		vTaskDelayUntil(&wake, setpoint_period_ticks());
+	}
+	setpoint_release();
+	landing_timeout = settle.timed_out;
+	landing_ms = T2M(xTaskGetTickCount() - start);
+	if (debug==1) DEBUG_PRINT("Landing: %lu ms, segment %.2f s%s\n", landing_ms, (double)segment.duration, settle.timed_out ? ", hold timed out" : "");
+}
 
-    float height = pos.z;
-    float current_yaw = logGetFloat(logGetVarId("stateEstimate", "yaw"));
+/* --------------- Filtering-processing --------------- */
 
-    for(int i=(int)100*height; i>100*FINAL_LANDING_HEIGHT; i--) {
-		headToPosition(pos.x, pos.y, (float)i / 100.0f, current_yaw);
-		vTaskDelay(20);
+void fusion_setup(void)
+{
+	fusion_init(&fusion);
+	for (int i = 0; i < FUSION_MAX_SOURCES; i++) {
+		fusion.config[i] = (fusion_source_config_t){ .enable = 1, .required = 0,
+			.weight = FUSION_NET_WEIGHT, .max_age_us = FUSION_NET_AGE_MS * 1000 };
 	}
-	vTaskDelay(200);
+	fusion.config[FUSION_DRONET] = (fusion_source_config_t){ .enable = 1, .required = 1,
+		.weight = 1.0f, .max_age_us = FUSION_DRONET_AGE_MS * 1000 };
 }
 
-/* --------------- Filtering-processing --------------- */
+// DroNet as a fusion source: steering as is, speed limited by the collision probability
+void fusion_publish_dronet(const float* filtered, uint32_t timestamp)
+{
+	float collision = filtered[CNN_COLLISION];
+	collision = collision < 0.0f ? 0.0f : (collision > 1.0f ? 1.0f : collision);
+	fusion_command_t command = { .steering = filtered[CNN_STEERING], .speed = 1.0f - collision, .confidence = 1.0f };
+	fusion_publish(&fusion, FUSION_DRONET, timestamp, &command);
+	fusion_new = 1;
+}
+
+// Fuse the latest results at the common tick "now" and step the control law with them.
+// Runs on every UART task wakeup, timeouts included, so results age out even if no frame arrives:
+// the law steps once per new result, and on every tick without a fresh DroNet result it is fed "stop, straight ahead".
+void control_update(uint32_t now)
+{
+	uint8_t published = __atomic_exchange_n(&fusion_new, 0, __ATOMIC_ACQ_REL); 	// a frame may set it meanwhile
+	fusion_tick(&fusion, now, &fused);
+	if (!control_enable) return;
+	if (!published && fused.valid) return;
+	float steering = fused.valid ? fused.command.steering : 0.0f;
+	float collision = fused.valid ? 1.0f - fused.command.speed : 1.0f;
+	dronet_control_step(&control_config, &control, steering, collision);
+	if (fused.valid) {
+		control_lat_us = (uint32_t)usecTimestamp() - fused.t_newest_us;
+		if (control_lat_us > control_lat_max) control_lat_max = control_lat_us;
+	}
+}
+
+// Control updates per second, over 1 s windows
+void control_rate_update(uint32_t now_us)
+{
+	uint32_t elapsed = now_us - control_window_us;
+	if (elapsed < 1000000) return;
+	control_rate_hz = (float)(control.steps - control_window_steps) * 1e6f / (float)elapsed;
+	control_window_steps = control.steps;
+	control_window_us = now_us;
+}
 
-float low_pass_filtering(float data_new, float data_old, float alpha)
+// Temporal filters of the CNN outputs, dt taken from the DMA interrupt time of the frame
+void filter_cnn_output(const float* cnn_output_float, uint32_t timestamp, float* filtered)
 {
-	float output;
-	// Low pass filter the forward velocity
-	output = (1.0f - alpha) * data_new + alpha * data_old;
-	return output;
+	for (int i = 0; i < CNN_OUTPUTS; i++) {
+		filtered[i] = filter_update(&filter_config[i], &filter_state[i], cnn_output_float[i], timestamp);
+	}
 }
 
 int find_max_index(float* array, int size)
@@ -214,86 +534,156 @@ int find_max_index(float* array, int size)
 	return index;
 }
 
-double sigmoid(float x)
+float sigmoid(float x)
 {
-     float result;
-     result = 1 / (1 + expf(-x));
-     return result;
+	return act_sigmoid(x, ACTIVATION_TIER);
 }
 
+// in place: logits -> probabilities
 void softmax(float* array, uint8_t softmax_range){
-	int idx_max;
-	idx_max = find_max_index(array, softmax_range);
+	act_softmax(array, array, softmax_range, ACTIVATION_TIER);
+}
+/* --------------- Other Manouvers --------------- */
 
-	for(int i=0; i<softmax_range; i++){
-		if (idx_max == i){
-			array[i] = 1.0;
-		}
-		else{
-			array[i] = 0.0;
-		}
+// Manoeuvres are step functions, run once per flight_loop() tick by the executor (maneuver.h).
+// Their state lives in maneuver_run: locals do not survive a yield.
+
+// Start manoeuvre "id" from a clean context; false if another one is running
+bool maneuver_launch(uint8_t id, maneuver_step_t step, const maneuver_run_t *run)
+{
+	if (maneuver_active(&maneuvers)) return false;
+	maneuver_run = *run;
+	return maneuver_start(&maneuvers, id, step, &maneuver_run, T2M(xTaskGetTickCount()));
+}
+
+// Build the arc-length table of the path selected in the PATH parameters
+bool path_build(void)
+{
+	const float waypoints[][2] = PATH_WAYPOINTS;
+	path_config_t config;
+	_Static_assert(sizeof(waypoints) <= sizeof(config.waypoints), "PATH_WAYPOINTS: at most PATH_MAX_WAYPOINTS points");
+	memset(&config, 0, sizeof(config));
+	config.type = path_type;
+	config.size = path_size;
+	config.sides = path_sides;
+	config.n_waypoints = sizeof(waypoints) / sizeof(config.waypoints[0]);
+	config.closed = PATH_WAYPOINTS_CLOSED;
+	memcpy(config.waypoints, waypoints, sizeof(waypoints));
+
+	uint64_t t0 = usecTimestamp();
+	bool valid = path_init(&path, &config);
+	path_build_us = (uint32_t)(usecTimestamp() - t0);
+	if (!valid || path_speed <= 0.0f) {
+		if (debug==1) DEBUG_PRINT("Invalid path: type %d, size %f, speed %f\n", path_type, (double)path_size, (double)path_speed);
+		return false;
 	}
+	return true;
 }
-/* --------------- Other Manouvers --------------- */
 
-void flyCircle(float radius, float velocity){
+// Fly "path_laps" laps of the selected path at constant speed, starting from the current position.
+// Clearing MANOUVERS/circle stops it where it is.
+maneuver_status_t fly_path_step(maneuver_t *m, uint32_t now_ms)
+{
+	maneuver_run_t *run = m->ctx;
+	float s = path_speed * (now_ms - m->start_ms) / 1000.0f; 	// [m] flown so far
+	float x, y;
+	MANEUVER_BEGIN(m);
+	if (!path_build()) return MANEUVER_DONE;
+	state_snapshot(&run->start);
+	run->distance = path.closed ? path_laps * path.length : path.length;
+
+	// one sample of the arc-length table per tick, at the distance flown so far
+	while (s < run->distance && circle) {
+		path_sample(&path, s, &x, &y, NULL, NULL);
+		headToPosition(run->start.x + x, run->start.y + y, run->start.z, 0);
+		MANEUVER_YIELD(m);
+	}
+	path_sample(&path, s < run->distance ? s : run->distance, &x, &y, NULL, NULL);
+	headToPosition(run->start.x + x, run->start.y + y, run->start.z, 0);
+	MANEUVER_END(m);
+}
 
-	float distance = 2.0f*PI*radius;
-    uint16_t steps = distance/velocity*1000/100; //one step is 100ms
+bool flyPath(void){
+	maneuver_run_t run = { 0 };
+	return maneuver_launch(MANEUVER_PATH, fly_path_step, &run);
+}
 
-	point_t pos;
-	memset(&pos, 0, sizeof(pos));
-	estimatorKalmanGetEstimatedPos(&pos);
+// Record the cost of the spin that just ended: duration, setpoints written, app-task cycles spent on them
+void spin_done(uint32_t elapsed_ms, const maneuver_run_t *run)
+{
+	spin_ms = elapsed_ms;
+	spin_writes = run->writes;
+	spin_cycles = run->cycles;
+}
 
-    for (int i = 0; i < steps; i++) {
-        float a = M_PI + i*2*M_PI/steps + 4;
-        float x = (float)cos(a)*radius + radius + pos.x;
-        float y = (float)sin(a)*radius + pos.y;
-        headToPosition(x, y, pos.z, 0);
-        vTaskDelay(100);
-    }
+// Minimum-jerk yaw profile, one sample per tick
+maneuver_status_t spin_t_step(maneuver_t *m, uint32_t now_ms)
+{
+	maneuver_run_t *run = m->ctx;
+	float t = (now_ms - m->start_ms) / 1000.0f;
+	uint32_t c0 = CYCLES();
+	MANEUVER_BEGIN(m);
+	state_snapshot(&run->start);
+	traj_segment_init_timed(&run->yaw, run->start.yaw, run->start.yaw + run->angle, run->duration_ms / 1000.0f, TRAJ_MIN_JERK);
+	if (debug==2) DEBUG_PRINT("\n\n[spin_in_place_t_cost]\n current_yaw %f, angle %f, time %lu\n\n", (double)run->start.yaw, (double)run->angle, run->duration_ms);
+
+	while (t < run->yaw.duration) {
+		headToPosition(run->start.x, run->start.y, run->start.z, traj_wrap_deg(traj_segment_sample(&run->yaw, t, NULL, NULL)));
+		run->writes++;
+		run->cycles += CYCLES() - c0;
+		MANEUVER_YIELD(m);
+	}
+	headToPosition(run->start.x, run->start.y, run->start.z, traj_wrap_deg(run->start.yaw + run->angle));
+	run->writes++;
+	run->cycles += CYCLES() - c0;
+	spin_done(now_ms - m->start_ms, run);
+	MANEUVER_END(m);
 }
 
-void spin_in_place_t_cost(float angle, float time){
+bool spin_in_place_t_cost(float angle, float time){
 	/*
 	angle [deg]: given the current orientation, spin by "angle" degrees in place;
 	time   [ms]: how much time to perform the entire manuever --> impacts the spinning speed;
+	the yaw follows a minimum-jerk profile, one sample per tick
 	*/
+	maneuver_run_t run = { .angle = angle, .duration_ms = (uint32_t)time };
+	return maneuver_launch(MANEUVER_SPIN_T, spin_t_step, &run);
+}
 
-    float current_yaw;					// fetch current yaw self estimation
-    float t_steps = 1; 					// [ms] time steps
-    float n_steps = (time/(t_steps)); 	// number of  steps
-    float r_steps = (angle/n_steps); 	// angle steps
-	float new_yaw;						// new yaw given to the controller. This parameter is updated by the for loop
-
-	// access self estimation
-	point_t pos;
-	memset(&pos, 0, sizeof(pos));
-	estimatorKalmanGetEstimatedPos(&pos);
-	current_yaw = logGetFloat(logGetVarId("stateEstimate", "yaw"));
-	if (debug==2) DEBUG_PRINT("\n\n[spin_in_place_t_cost]\n current_yaw %f, t_steps %f, n_steps %f, r_steps %f\n\n", current_yaw, t_steps, n_steps, r_steps);
-
-	// perform manuever
-    for (int i = 0; i <= n_steps; i++) {
-        new_yaw = (i*r_steps) + current_yaw;
-    	if (debug==3) DEBUG_PRINT("%f\n",(double)new_yaw);
-		headToPosition(pos.x, pos.y, pos.z, new_yaw);
-		vTaskDelay(M2T(t_steps));
-    }
+// One yaw-rate setpoint for the whole spin, then the final heading is held in position mode
+maneuver_status_t spin_yr_step(maneuver_t *m, uint32_t now_ms)
+{
+	maneuver_run_t *run = m->ctx;
+	uint32_t c0 = CYCLES();
+	MANEUVER_BEGIN(m);
+	state_snapshot(&run->start);
+	headToVelocity(0.0f, 0.0f, run->start.z, run->yaw_rate);
+	run->writes++;
+	run->cycles += CYCLES() - c0;
+
+	MANEUVER_WAIT_UNTIL(m, now_ms - m->start_ms >= run->duration_ms);
+	headToPosition(run->start.x, run->start.y, run->start.z, traj_wrap_deg(run->start.yaw + run->angle));
+	run->writes++;
+	run->cycles += CYCLES() - c0;
+	spin_done(now_ms - m->start_ms, run);
+	MANEUVER_END(m);
 }
 
-void spin_in_place_yawrate_cost(float angle, float yaw_rate){
+bool spin_in_place_yawrate_cost(float angle, float yaw_rate){
 	/*
 	angle 	 [deg]  : given the current orientation, spin by "angle" degrees in place;
 	yaw_rate [deg/s]: constant yaw rate for rotation --> impacts the spinning time;
 	*/
-	float time = abs((angle/yaw_rate) * 1000); // [ms]
-	if (debug==2) DEBUG_PRINT("\n\n [spin_in_place_yawrate_cost]\n angle %f, yaw_rate %f, time %f\n\n", angle, yaw_rate, time);
-    spin_in_place_t_cost(angle, time);
+	if (yaw_rate == 0.0f) return false;
+	float time = fabsf((angle/yaw_rate) * 1000); // [ms]
+	if (debug==2) DEBUG_PRINT("\n\n [spin_in_place_yawrate_cost]\n angle %f, yaw_rate %f, time %f\n\n", (double)angle, (double)yaw_rate, (double)time);
+	maneuver_run_t run = { .angle = angle, .yaw_rate = angle < 0.0f ? -fabsf(yaw_rate) : fabsf(yaw_rate),
+		.duration_ms = (uint32_t)time };
+	return maneuver_launch(MANEUVER_SPIN_YR, spin_yr_step, &run);
 }
 
 
-void spin_in_place_random(float starting_random_angle, float yaw_rate, float rand_range){
+bool spin_in_place_random(float starting_random_angle, float yaw_rate, float rand_range){
 	/**
 	 * spin to a random angle. The random angle is chosen between starting_random_angle +/- rand_range
 	 */
@@ -304,18 +694,14 @@ void spin_in_place_random(float starting_random_angle, float yaw_rate, float ran
 		random_angle = -(360 - random_angle);
 	}
 	if (debug==2) DEBUG_PRINT("\n\n [spin_in_place_random]:\n starting_random_angle %f, yaw_rate %f, rand_range %f, random_angle %f", starting_random_angle, yaw_rate, rand_range, random_angle);
-	spin_in_place_yawrate_cost(random_angle, yaw_rate);
-
+	return spin_in_place_yawrate_cost(random_angle, yaw_rate);
 }
 
 
 void check_decks_properly_mounted(uint8_t stop_on_error){
-	// Getting Param IDs of the deck driver initialization
-	paramVarId_t idPositioningDeck = paramGetVarId("deck", "bcFlow2");
-	paramVarId_t idMultiranger = paramGetVarId("deck", "bcMultiranger");
-    // Check if decks are properly mounted
-    uint8_t positioningInit = paramGetUint(idPositioningDeck);
-    uint8_t multirangerInit = paramGetUint(idMultiranger);
+    // Check if decks are properly mounted: deck driver initialization params
+    uint8_t positioningInit = state_param_uint(STATE_DECK_FLOW);
+    uint8_t multirangerInit = state_param_uint(STATE_DECK_MULTIRANGER);
 
 	if (!multirangerInit || !positioningInit){
 		if (debug==1) DEBUG_PRINT("Decks with value 0 are not mounted correctly:\n Flow %d, Multiranger %d\n" , positioningInit, multirangerInit );
@@ -333,33 +719,100 @@ void check_decks_properly_mounted(uint8_t stop_on_error){
 /* ------------------------------------------------------------------------- */
 /* ------------------------------ Flight Loop ------------------------------ */
 /* ------------------------------------------------------------------------- */
-void flight_loop(){
 
-	if (circle==1){
-		if (debug==1) DEBUG_PRINT("Cicle!\n");
-		flyCircle(0.5, 0.5);
+// Commands of the DroNet control law, or straight ahead at the maximum speed when it is disabled
+void control_commands(float *speed, float *yaw_rate)
+{
+	if (control_enable) {
+		*speed = control.speed;
+		*yaw_rate = control.yaw_rate;
+	} else {
+		*speed = control_config.max_speed;
+		*yaw_rate = 0.0f;
 	}
+}
 
-	if (spin_drone==1){
-		if (debug==1) DEBUG_PRINT("SPIN IN PLACE (t constant)!\n");
-		spin_in_place_t_cost(spin_angle, spin_time);
-		spin_drone=0;
+// Grade the AI-deck link; latch the position to hold when entering LINK_HOVER
+link_level_t link_check(void)
+{
+	if (!wd_enable) return LINK_OK;
+
+	uint8_t previous = link_watchdog.level;
+	link_age_ms = link_health_age_us(&link_health, (uint32_t)usecTimestamp()) / 1000;
+	link_level_t level = link_watchdog_step(&link_watchdog, T2M(xTaskGetTickCount()), link_age_ms);
+	if (level != previous) {
+		if (debug==1) DEBUG_PRINT("AI-deck link: level %d -> %d, no frame for %lu ms\n", previous, level, link_age_ms);
+		if (level == LINK_HOVER) {
+			state_snapshot(&hover_pos);
+		}
 	}
+	return level;
+}
+
+// One executor step, timed; true if a manoeuvre wrote the setpoint of this tick
+bool maneuver_update(uint32_t now_ms)
+{
+	uint32_t c0 = CYCLES();
+	bool ran = maneuver_tick(&maneuvers, now_ms);
+	uint32_t cycles = CYCLES() - c0;
+	if (ran && cycles > maneuver_step_max) maneuver_step_max = cycles;
+	return ran;
+}
+
+// One control tick: never blocks, so the watchdog and stop requests are serviced while a manoeuvre runs
+void flight_loop(){
+	float speed, yaw_rate;
+	control_commands(&speed, &yaw_rate);
 
-	if (spin_drone_yr==1){
-		if (debug==1) DEBUG_PRINT("SPIN IN PLACE (yaw rate constant)!\n");
-		spin_in_place_yawrate_cost(spin_angle, spin_yawrate);
-		spin_drone_yr=0;
+	link_level_t level = link_check();
+	if (level != LINK_OK) {
+		maneuver_abort(&maneuvers); 	// the failsafe takes over the setpoint
+	}
+	switch (level) {
+		case LINK_LAND:
+			if (debug==1) DEBUG_PRINT("AI-deck link lost: landing\n");
+			land();
+			landed = 1;
+			fly = 0;
+			return;
+		case LINK_HOVER:
+			headToPosition(hover_pos.x, hover_pos.y, flying_height, hover_pos.yaw);
+			return;
+		case LINK_SLOW:
+			headToVelocity(wd_slow_factor * speed, 0.0, flying_height, yaw_rate);
+			return;
+		default:
+			break;
 	}
 
-	if (spin_drone_random==1){
-		if (debug==1) DEBUG_PRINT("SPIN IN PLACE (random)!\n");
-		spin_in_place_random(spin_angle, spin_yawrate, max_rand_angle);
-		spin_drone_random=0;
+	// a request waits for the running manoeuvre to end
+	if (!maneuver_active(&maneuvers)) {
+		if (circle==1){
+			if (debug==1) DEBUG_PRINT("Path %d!\n", path_type);
+			flyPath();
+		}
+		else if (spin_drone==1){
+			if (debug==1) DEBUG_PRINT("SPIN IN PLACE (t constant)!\n");
+			spin_in_place_t_cost(spin_angle, spin_time);
+			spin_drone=0;
+		}
+		else if (spin_drone_yr==1){
+			if (debug==1) DEBUG_PRINT("SPIN IN PLACE (yaw rate constant)!\n");
+			spin_in_place_yawrate_cost(spin_angle, spin_yawrate);
+			spin_drone_yr=0;
+		}
+		else if (spin_drone_random==1){
+			if (debug==1) DEBUG_PRINT("SPIN IN PLACE (random)!\n");
+			spin_in_place_random(spin_angle, spin_yawrate, max_rand_angle);
+			spin_drone_random=0;
+		}
+	}
+	if (maneuver_update(T2M(xTaskGetTickCount()))) {
+		return;
 	}
 
 	// Give setpoint to the controller
-	headToVelocity(forward_vel, 0.0, flying_height, 0.0);
+	headToVelocity(speed, 0.0, flying_height, yaw_rate);
 
 }
 
@@ -367,43 +820,434 @@ void flight_loop(){
 
 // CNN POST-PROCESSING
 
-void process_cnn_output(int32_t* cnn_output_int, float* cnn_output_float)
+// Scales, clamps and activations of each head are in the DRONET_HEADS table (networks.h)
+void process_cnn_output(int32_t* cnn_output_int, const int32_t* zero_point, const float* scale, float* cnn_output_float)
+{
+    decode_quant_t quant[CNN_OUTPUTS];
+    for (int i = 0; i < CNN_OUTPUTS; i++) {
+        quant[i].scale = scale[i];
+        quant[i].zero_point = zero_point[i];
+    }
+    // the widened outputs have the layout of a UART_MSG_INFERENCE payload
+    dronet_decode((const uint8_t *)cnn_output_int, quant, &dronet_output);
+    cnn_output_float[CNN_STEERING] = dronet_output.steering[0];
+    cnn_output_float[CNN_COLLISION] = dronet_output.collision[0];
+}
+
+/* --------------- UART link --------------- */
+
+// Queued with the other outgoing frames, so the link has a single TX sequence counter
+void baud_send_request(uint32_t baud, void *ctx)
+{
+	uart_tx_frame(&uart_tx, UART_MSG_BAUD_REQ, &baud, sizeof(baud));
+	uart_tx_poll(&uart_tx, T2M(xTaskGetTickCount()));
+}
+
+void baud_apply(uint32_t baud, void *ctx)
+{
+	if (debug==1) DEBUG_PRINT("UART baud rate -> %lu\n", baud);
+	USART_DMA_SetBaudrate(baud);
+	uart_baudrate = baud;
+}
+
+void uart_baud_start(void)
+{
+	uart_baud_config_t config = {
+		.rates = UART_HIGH_SPEED_RATES,
+		.ack_timeout_ms = 200,
+		.window_ms = 1000,
+		.min_frames = 5,
+		.max_error_pct = 5,
+		.keepalive_ms = 250,
+		.holdoff_ms = 3000,
+	};
+	uart_baud_io_t io = { .send_request = baud_send_request, .apply = baud_apply, .ctx = NULL };
+	uart_baud_init(&uart_baud, &config, &io);
+}
+
+// Called by the consumer task on every wake-up
+void uart_baud_update(void)
+{
+	uint32_t now = T2M(xTaskGetTickCount());
+	uint32_t frames = uart_parser.stats.frames;
+	uint32_t errors = uart_parser.stats.crc_errors + uart_parser.stats.resyncs;
+
+	if (baud_ack_new) {
+		baud_ack_new = 0;
+		uart_baud_on_ack(&uart_baud, baud_ack_value, now, frames, errors);
+	}
+	uart_baud_step(&uart_baud, now, frames, errors);
+}
+
+bool uart_tx_start(const uint8_t *data, uint32_t len, void *ctx)
+{
+	return USART_DMA_Send(data, len) == PASSED;
+}
+
+bool uart_tx_busy(void *ctx)
+{
+	return USART_DMA_TxBusy();
+}
+
+// Resolve the log/param ids, and measure a read by name against a cached one
+void state_registry_setup(void)
+{
+	state_missing = state_registry_init();
+	if (state_missing && debug==1) DEBUG_PRINT("%d log/param variables missing\n", state_missing);
+
+	uint32_t sum[STATE_BENCH_N] = { 0 };
+	for (int i = 0; i < STATE_BENCH_N; i++) state_bench_min[i] = UINT32_MAX;
+	for (int run = 0; run < STATE_BENCH_RUNS; run++) {
+		uint32_t c0 = CYCLES();
+		volatile float yaw = logGetFloat(logGetVarId("stateEstimate", "yaw"));
+		uint32_t c1 = CYCLES();
+		yaw = state_get_float(STATE_YAW);
+		uint32_t c2 = CYCLES();
+		state_snapshot_t state;
+		state_snapshot(&state);
+		uint32_t c3 = CYCLES();
+		(void)yaw;
+		uint32_t cycles[STATE_BENCH_N] = { c1 - c0, c2 - c1, c3 - c2 };
+		for (int i = 0; i < STATE_BENCH_N; i++) {
+			sum[i] += cycles[i];
+			if (cycles[i] < state_bench_min[i]) state_bench_min[i] = cycles[i];
+		}
+	}
+	for (int i = 0; i < STATE_BENCH_N; i++) state_bench_mean[i] = sum[i] / STATE_BENCH_RUNS;
+}
+
+void state_stream_init(void)
+{
+	uart_tx_io_t io = { .start = uart_tx_start, .busy = uart_tx_busy, .ctx = NULL };
+	uart_tx_init(&uart_tx, &io);
+}
+
+// Queue a state snapshot when one is due and keep the TX DMA busy. Never blocks.
+void state_stream_update(uint32_t now)
+{
+	if (state_rate > 0 && now - state_t_last >= 1000 / state_rate) {
+		state_t_last = now;
+		state_snapshot_t state;
+		state_snapshot(&state);
+		uart_state_msg_t msg = {
+			.timestamp 	 = now,
+			.vx 		 = state.vx,
+			.vy 		 = state.vy,
+			.vz 		 = state.vz,
+			.z 			 = state.z,
+			.yaw 		 = state.yaw,
+			.range_front = state.range_front,
+			.range_back  = state.range_back,
+			.range_left  = state.range_left,
+			.range_right = state.range_right,
+			.range_up 	 = state.range_up,
+		};
+		uart_tx_frame(&uart_tx, UART_MSG_STATE, &msg, sizeof(msg));
+	}
+	uart_tx_poll(&uart_tx, now);
+}
+
+/* --------------- UART channels (handlers run in the DMA interrupt) --------------- */
+
+// Every format is dequantized with the quantization table as of the frame's arrival
+void on_inference_frame(const uart_frame_t *frame, void *ctx)
+{
+	inference_record_t record;
+	record.timestamp = uart_rx_timestamp;
+	record.t_irq = uart_rx_cycles;
+	record.seq = frame->seq;
+	record.n_outputs = uart_frame_unpack_outputs(frame, record.outputs, CNN_OUTPUTS);
+	link_health_frame(&link_health, uart_rx_timestamp);
+
+	// a value stuck at the limit of its wire type means the quantization range overflowed
+	int32_t q_max = frame->msg_id == UART_MSG_INFERENCE_Q8 ? INT8_MAX : (frame->msg_id == UART_MSG_INFERENCE_Q16 ? INT16_MAX : INT32_MAX);
+	for (int i = 0; i < record.n_outputs; i++) {
+		if (record.outputs[i] >= q_max || record.outputs[i] < -q_max) quant_saturated[i]++;
+		record.scale[i] = quant_table[i].scale;
+		record.zero_point[i] = quant_table[i].zero_point;
+	}
+	record.t_decode = CYCLES();
+	if (inference_queue_push(&inference_queue, &record)) uart_wakeup = 1;
+}
+
+// Same scale and zero point for every output
+void on_quant_header_frame(const uart_frame_t *frame, void *ctx)
+{
+	uart_quant_msg_t msg;
+	memcpy(&msg, frame->payload, sizeof(msg));
+	for (int i = 0; i < CNN_OUTPUTS; i++) {
+		quant_table[i].scale = msg.scale;
+		quant_table[i].zero_point = msg.zero_point;
+	}
+}
+
+void on_quant_table_frame(const uart_frame_t *frame, void *ctx)
+{
+	uint8_t first = frame->payload[0];
+	uint8_t n = (frame->len - sizeof(uart_quant_table_msg_t)) / sizeof(uart_quant_msg_t);
+	if ((frame->len - sizeof(uart_quant_table_msg_t)) % sizeof(uart_quant_msg_t) != 0 || first + n > CNN_OUTPUTS) {
+		quant_table_errors++;
+		return;
+	}
+	for (uint8_t i = 0; i < n; i++) {
+		uart_quant_msg_t entry;
+		memcpy(&entry, &frame->payload[sizeof(uart_quant_table_msg_t) + i * sizeof(entry)], sizeof(entry));
+		quant_table[first + i].scale = entry.scale;
+		quant_table[first + i].zero_point = entry.zero_point;
+	}
+}
+
+// Result of an auxiliary network, dated back to its camera frame
+void on_net_command_frame(const uart_frame_t *frame, void *ctx)
+{
+	uart_net_command_msg_t msg;
+	memcpy(&msg, frame->payload, sizeof(msg));
+	if (msg.net_id == FUSION_DRONET || msg.net_id >= FUSION_MAX_SOURCES) {
+		net_command_errors++;
+		return;
+	}
+	fusion_command_t command = {
+		.steering = msg.steering / 32767.0f,
+		.speed = msg.speed / 65535.0f,
+		.confidence = msg.confidence / 255.0f,
+	};
+	fusion_publish(&fusion, msg.net_id, uart_rx_timestamp - msg.latency_ms * 1000u, &command);
+	fusion_new = 1;
+	uart_wakeup = 1;
+}
+
+void on_tensor_row(const tensor_rx_t *rx, uint16_t row, void *ctx)
+{
+	uart_wakeup = 1;
+}
+
+void on_tensor_frame(const uart_frame_t *frame, void *ctx)
+{
+	uart_tensor_chunk_t chunk;
+	memcpy(&chunk, frame->payload, sizeof(chunk));
+	for (int i = 0; i < N_TENSORS; i++) {
+		if (tensor_schemas[i].id == chunk.tensor_id) {
+			tensor_rx_chunk(&tensor_rx[i], chunk.frame, chunk.offset,
+				&frame->payload[sizeof(chunk)], frame->len - sizeof(chunk));
+			return;
+		}
+	}
+}
+
+void on_baud_ack_frame(const uart_frame_t *frame, void *ctx)
+{
+	memcpy((void *)&baud_ack_value, frame->payload, sizeof(uint32_t));
+	baud_ack_new = 1;
+	uart_wakeup = 1;
+}
+
+void on_debug_text_frame(const uart_frame_t *frame, void *ctx)
+{
+	if (debug_text_len != 0) {
+		debug_text_dropped++;
+		return;
+	}
+	memcpy(debug_text, frame->payload, frame->len);
+	debug_text_len = frame->len;
+	uart_wakeup = 1;
+}
+
+void on_config_ack_frame(const uart_frame_t *frame, void *ctx)
+{
+	config_ack_id = frame->payload[0];
+	config_ack_status = frame->payload[1];
+}
+
+void on_timing_probe_frame(const uart_frame_t *frame, void *ctx)
+{
+	memcpy(&timing_probe, frame->payload, sizeof(timing_probe));
+	timing_probe.t_rx = uart_rx_timestamp;
+	timing_probe_new = 1;
+	uart_wakeup = 1;
+}
+
+// Compile-time dispatch table: message id, accepted payload length, handler.
+// Lengths are independent of UART_RX_BUFFER_SIZE: the parser reassembles frames across DMA chunks.
+enum { CH_INFERENCE = 0, CH_INFERENCE_Q8, CH_INFERENCE_Q16, CH_QUANT, CH_QUANT_TABLE, CH_NET_COMMAND, CH_TENSOR, CH_BAUD_ACK, CH_DEBUG_TEXT, CH_CONFIG_ACK, CH_TIMING, UART_N_CHANNELS };
+const uart_channel_t uart_channels[UART_N_CHANNELS] = {
+	[CH_INFERENCE] 	= { UART_MSG_INFERENCE, 	4*CNN_OUTPUTS, 	4*CNN_OUTPUTS, 	on_inference_frame },
+	[CH_INFERENCE_Q8]  = { UART_MSG_INFERENCE_Q8,  CNN_OUTPUTS, CNN_OUTPUTS, 	on_inference_frame },
+	[CH_INFERENCE_Q16] = { UART_MSG_INFERENCE_Q16, 2*CNN_OUTPUTS, 2*CNN_OUTPUTS, on_inference_frame },
+	[CH_QUANT] 		= { UART_MSG_QUANT_HEADER, 	sizeof(uart_quant_msg_t), sizeof(uart_quant_msg_t), on_quant_header_frame },
+	[CH_QUANT_TABLE] = { UART_MSG_QUANT_TABLE, sizeof(uart_quant_table_msg_t) + sizeof(uart_quant_msg_t), UART_FRAME_MAX_PAYLOAD, on_quant_table_frame },
+	[CH_NET_COMMAND] = { UART_MSG_NET_COMMAND, sizeof(uart_net_command_msg_t), sizeof(uart_net_command_msg_t), on_net_command_frame },
+	[CH_TENSOR] 	= { UART_MSG_TENSOR, 		sizeof(uart_tensor_chunk_t) + 1, UART_FRAME_MAX_PAYLOAD, on_tensor_frame },
+	[CH_BAUD_ACK] 	= { UART_MSG_BAUD_ACK, 		4, 				4, 				on_baud_ack_frame },
+	[CH_DEBUG_TEXT] = { UART_MSG_DEBUG_TEXT, 	1, 				DEBUG_TEXT_SIZE, on_debug_text_frame },
+	[CH_CONFIG_ACK] = { UART_MSG_CONFIG_ACK, 	2, 				2, 				on_config_ack_frame },
+	[CH_TIMING] 	= { UART_MSG_TIMING_PROBE, 	sizeof(uart_timing_msg_t), sizeof(uart_timing_msg_t), on_timing_probe_frame },
+};
+uart_channel_stats_t uart_channel_stats[UART_N_CHANNELS];
+uint32_t inference_len_errors = 0; 	// length errors of the int32, Q16 and Q8 inference channels
+
+// Runs in the DMA interrupt, or in the UART task with it masked: parse every byte received so far
+void uart_rx_process(uint32_t timestamp)
+{
+	uart_rx_timestamp = timestamp;
+#if UART_RX_DOUBLE_BUFFER
+	// zero-copy, one contiguous span of a DMA buffer at a time
+	const uint8_t *data;
+	uint32_t n;
+	while ((n = USART_DMA_Peek(&data)) > 0) {
+		uart_frame_parse(&uart_parser, data, n, uart_channel_dispatch, &uart_dispatch);
+		USART_DMA_Consume(n);
+	}
+#else
+	uint8_t rx_bytes[UART_RX_BUFFER_SIZE];
+	uint32_t n;
+	while ((n = USART_DMA_Read(rx_bytes, sizeof(rx_bytes))) > 0) {
+		uart_frame_parse(&uart_parser, rx_bytes, n, uart_channel_dispatch, &uart_dispatch);
+	}
+#endif
+}
+
+// App task side of the auxiliary channels
+uint32_t link_stats_t_last = 0; // [ms]
+void uart_channels_update(uint32_t now)
+{
+	inference_len_errors = uart_channel_stats[CH_INFERENCE].len_errors + uart_channel_stats[CH_INFERENCE_Q16].len_errors
+		+ uart_channel_stats[CH_INFERENCE_Q8].len_errors;
+
+	// receiver-side counters for the traffic generator on the other end
+	if (now - link_stats_t_last >= 1000) {
+		link_stats_t_last = now;
+		uart_link_stats_msg_t msg = {
+			.frames 		 = uart_parser.stats.frames,
+			.crc_errors 	 = uart_parser.stats.crc_errors,
+			.resyncs 		 = uart_parser.stats.resyncs,
+			.bytes_dropped 	 = uart_parser.stats.bytes_dropped,
+			.seq_gaps 		 = uart_parser.stats.seq_gaps,
+			.queue_overflows = inference_queue.overflows,
+			.latency_max 	 = latency_max,
+		};
+		uart_tx_frame(&uart_tx, UART_MSG_LINK_STATS, &msg, sizeof(msg));
+	}
+
+	if (debug_text_len != 0) {
+		DEBUG_PRINT("[GAP9] %.*s\n", (int)debug_text_len, debug_text);
+		debug_text_len = 0;
+	}
+	if (timing_probe_new) {
+		timing_probe_new = 0;
+		timing_probe.t_tx = (uint32_t)usecTimestamp();
+		uart_tx_frame(&uart_tx, UART_MSG_TIMING_PROBE, &timing_probe, sizeof(timing_probe));
+	}
+}
+
+// Depth grid: keep the closest value of each row, the whole grid once its last row is in
+void process_depth_row(const int8_t *grid, uint16_t row)
+{
+	qpost_pool_s8(&grid[row * DEPTH_GRID_COLS], &depth_row_min[row], 1, DEPTH_GRID_COLS, 1, DEPTH_GRID_COLS, QPOST_POOL_MIN);
+	if (row == DEPTH_GRID_ROWS - 1) {
+		qpost_pool_s8(depth_row_min, &depth_min, DEPTH_GRID_ROWS, 1, DEPTH_GRID_ROWS, 1, QPOST_POOL_MIN);
+		// the whole grid is in: decode it to meters
+		depth_decode((const uint8_t *)grid, NULL, &depth_output);
+		depth_near = DEPTH_GRID_RANGE;
+		for (int i = 0; i < DEPTH_GRID_ROWS * DEPTH_GRID_COLS; i++) {
+			if (depth_output.depth[i] < depth_near) depth_near = depth_output.depth[i];
+		}
+	}
+}
+
+// Process the tensor rows completed since the last call, while the rest is still arriving
+void tensor_update(void)
+{
+	for (int i = 0; i < N_TENSORS; i++) {
+		uint8_t slot, frame;
+		uint16_t rows;
+		if (!tensor_rx_progress(&tensor_rx[i], &slot, &frame, &rows)) continue;
+		if (frame != tensor_frame[i]) {
+			if (tensor_frame[i] != TENSOR_NONE && tensor_rows_done[i] < tensor_schemas[i].rows) tensor_rows_skipped += tensor_schemas[i].rows - tensor_rows_done[i];
+			tensor_frame[i] = frame;
+			tensor_rows_done[i] = 0;
+		}
+		for (; tensor_rows_done[i] < rows; tensor_rows_done[i]++) {
+			if (i == TENSOR_DEPTH) process_depth_row((const int8_t *)tensor_rx_row(&tensor_rx[i], slot, 0), tensor_rows_done[i]);
+		}
+	}
+}
+
+void latency_histogram_add(uint32_t latency_us)
 {
-    // [0]=steering
-    cnn_output_float[0] = (float) (cnn_output_int[0] * nemo_quantum);
-    // [1]=collision
-    cnn_output_float[1] = (float) (cnn_output_int[1] * nemo_quantum);
+	uint8_t bin = 0;
+	uint32_t edge = 16;
+	while (bin < LATENCY_BINS-1 && latency_us >= edge){
+		edge <<= 2;
+		bin++;
+	}
+	latency_hist[bin]++;
+	latency_last = latency_us;
+	if (latency_us > latency_max) latency_max = latency_us;
+}
 
-    if(cnn_output_float[0] < -1.0f) cnn_output_float[0] = -1.0f;
-    if(cnn_output_float[0] > 1.0f) cnn_output_float[0]  = 1.0f;
-    // if(cnn_output_float[1] < 0.1f) cnn_output_float[1]  = 0.0f;
+// Wake-up timeout of the UART task: the IDLE poll period, at least 1 tick (0 would never block)
+TickType_t uart_task_timeout(void)
+{
+	TickType_t ticks = M2T(UART_IDLE_POLL_MS);
+	return ticks > 0 ? ticks : 1;
+}
+
+// IDLE line after a burst: deliver the tail sitting in a partly filled buffer. Polled, because the
+// USART3 vector belongs to the firmware's UART1 driver; the DMA interrupt is masked so the parser is not re-entered.
+void uart_rx_idle_poll(void)
+{
+	if (!USART_DMA_RxIdle()) return;
+	NVIC_DisableIRQ(USARTx_DMA_RX_IRQn);
+	uart_rx_cycles = CYCLES();
+	uart_rx_process((uint32_t)usecTimestamp());
+	uart_wakeup = 0; 	// this task drains the queue next
+	NVIC_EnableIRQ(USARTx_DMA_RX_IRQn);
 }
 
-void test_uart(){
+// UART consumer task, runs next to the flight loop of appMain
+void uart_task(void *param){
+
+	inference_record_t record;
+	inference_task = xTaskGetCurrentTaskHandle();
 
 	while (1){
-		vTaskDelay(100);
-		// If new UART data is available
-		if (dma_flag == 1)
+		// sleep until the DMA interrupt queues a result, the timeout polls the IDLE line
+		ulTaskNotifyTake(pdTRUE, uart_task_timeout());
+		uart_rx_idle_poll();
+#if UART_HIGH_SPEED
+		uart_baud_update();
+#endif
+		link_health_window(&link_health, (uint32_t)usecTimestamp(), 1000000,
+			uart_parser.stats.crc_errors + usartDmaStats.missed + inference_queue.overflows);
+		uart_channels_update(T2M(xTaskGetTickCount()));
+		tensor_update();
+		state_stream_update(T2M(xTaskGetTickCount()));
+		control_rate_update((uint32_t)usecTimestamp());
+
+		// drain every inference result queued by the DMA interrupt, oldest first
+		while (inference_queue_pop(&inference_queue, &record))
 		{
-            // timeout_counter = 0; // clear the flag
-            dma_flag = 0;  // clear the flag
-
-			// fetch int32 values
-			cnn_data_int[0] = ((int32_t *)pulpRxBuffer)[0];
-            cnn_data_int[1] = ((int32_t *)pulpRxBuffer)[1];
-            DEBUG_PRINT("1.UART data: %08x  %08x \n", (unsigned)((uint32_t *)pulpRxBuffer)[0], (unsigned)((uint32_t *)pulpRxBuffer)[1]);
-            DEBUG_PRINT("UART data (int32): %ld  %ld \n", cnn_data_int[0], cnn_data_int[1]);
-
-			// fetch float32 values
-			// cnn_data_float[0] = ((float *)pulpRxBuffer)[0];
-            // cnn_data_float[1] = ((float *)pulpRxBuffer)[1];
-			// DEBUG_PRINT("UART data (fp32) : %f  %f \n", cnn_data_float[0], cnn_data_float[1]);
+			latency_histogram_add((uint32_t)usecTimestamp() - record.timestamp);
+			memcpy(cnn_data_int, record.outputs, sizeof(cnn_data_int));
+			process_cnn_output(cnn_data_int, record.zero_point, record.scale, cnn_data_float);
+			filter_cnn_output(cnn_data_float, record.timestamp, cnn_filtered);
+			fusion_publish_dronet(cnn_filtered, record.timestamp);
+			latency_trace_begin(&latency_trace, record.seq, record.t_irq, record.t_decode, CYCLES());
+
+            if (debug==1) DEBUG_PRINT("UART data (int32): %ld  %ld  seq %u t %lu\n", cnn_data_int[CNN_STEERING], cnn_data_int[CNN_COLLISION], record.seq, record.timestamp);
+            if (debug==1) DEBUG_PRINT("UART frames %lu, crc errors %lu, resyncs %lu, queue overflows %lu\n",
+            	uart_parser.stats.frames, uart_parser.stats.crc_errors, uart_parser.stats.resyncs, inference_queue.overflows);
 		}
+		control_update((uint32_t)usecTimestamp());
 
 	}
 }
 
+uint32_t cycles_now(void)
+{
+	return CYCLES();
+}
+
 /* ------------------------------------------------------------------------ */
 /* ------------------------------    Main    ------------------------------ */
 /* ------------------------------------------------------------------------ */
@@ -418,15 +1262,43 @@ void appMain()
 	// init Kalman estimator
 	estimatorKalmanInit();
 
+	// enable the DWT cycle counter for latency tracing
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	latency_trace_init(&latency_trace, configCPU_CLOCK_HZ / 1e6f);
+	if (qpost_selftest(&qpost_bench, cycles_now) != 0) {
+		DEBUG_PRINT("Post-processing kernels: %lu mismatches with the C reference\n", qpost_bench.mismatches);
+	}
+
 	// UART-DMA setup for communication with AI-deck
-	USART_DMA_Start(115200, pulpRxBuffer, BUFFERSIZE);
+	uart_frame_parser_init(&uart_parser);
+	uart_dispatch_init(&uart_dispatch, uart_channels, uart_channel_stats, UART_N_CHANNELS, NULL);
+	inference_queue_init(&inference_queue);
+	link_health_init(&link_health, (uint32_t)usecTimestamp());
+	link_watchdog_config_t watchdog_config = { .slow_ms = WATCHDOG_SLOW_MS, .hover_ms = WATCHDOG_HOVER_MS, .land_ms = WATCHDOG_LAND_MS };
+	link_watchdog_init(&link_watchdog, &watchdog_config);
+	fusion_setup();
+	setpoint_buffer_init(&setpoint_buffer);
+	maneuver_executor_init(&maneuvers);
+	link_health_init(&setpoint_health, (uint32_t)usecTimestamp());
+	tensor_rx_init(&tensor_rx[TENSOR_DEPTH], &tensor_schemas[TENSOR_DEPTH], depth_arena, on_tensor_row, NULL);
+	for (int i = 0; i < N_TENSORS; i++) tensor_frame[i] = TENSOR_NONE;
+	state_stream_init(); 	// before uart_baud_start(): baud requests go through uart_tx
+	uart_baud_start();
+	state_registry_setup();
+#if UART_RX_DOUBLE_BUFFER
+	USART_DMA_StartDoubleBuffer(UART_BAUD_BASE, pulpRxBuffer[0], pulpRxBuffer[1], BUFFERSIZE);
+#else
+	USART_DMA_Start(UART_BAUD_BASE, pulpRxBuffer, BUFFERSIZE);
+#endif
 
 	// check decks are ok: flow and multiranger
 	// check_decks_properly_mounted((uint8_t) 0);
 
 	/* ------------------------ Main loop ------------------------ */
 
-	test_uart();
+	xTaskCreate(uart_task, "UART", UART_TASK_STACKSIZE, NULL, UART_TASK_PRI, NULL);
+	xTaskCreate(setpoint_task, "SETPOINT", SETPOINT_TASK_STACKSIZE, NULL, SETPOINT_TASK_PRI, NULL);
 
 	while(1) {
 		vTaskDelay(10);
@@ -442,6 +1314,7 @@ void appMain()
 		if (fly==0 && landed==0)
 		{
 			if (debug==1) DEBUG_PRINT("Landing\n");
+			maneuver_abort(&maneuvers);
 			land();
 			landed=1;
 		}
@@ -450,8 +1323,10 @@ void appMain()
 		if (fly==1 && landed==1)
 		{
 			if (debug==1) DEBUG_PRINT("Taking off\n");
+			dronet_control_reset(&control); 	// start the control law from hover
 			takeoff(flying_height);
 			landed=0;
+			link_watchdog_arm(&link_watchdog, T2M(xTaskGetTickCount()));
 		}
 
 		// flight loop
@@ -463,18 +1338,32 @@ void appMain()
 }
 
 
-uint64_t t0, t_frame, t_prev;
-// UART-DMA interrupt - triggered when a new inference result is available
+// Parse what arrived and wake the consumer only if a channel handler queued work for it
+void uart_rx_irq(void)
+{
+    uart_rx_process((uint32_t)usecTimestamp());
+
+    BaseType_t higher_prio_woken = pdFALSE;
+    if (uart_wakeup && inference_task != NULL) {
+        uart_wakeup = 0;
+        vTaskNotifyGiveFromISR(inference_task, &higher_prio_woken);
+    }
+    portYIELD_FROM_ISR(higher_prio_woken);
+}
+
+// UART-DMA interrupt - a DMA buffer (or half of the ring) is full
 void __attribute__((used)) DMA1_Stream1_IRQHandler(void)
 {
-    t_prev = t0;
-    t0 = xTaskGetTickCount();
-    t_frame = t0 - t_prev;
+    uart_rx_cycles = CYCLES();
+    if (DMA_GetFlagStatus(DMA1_Stream1, USARTx_RX_DMA_FLAG_TCIF) == SET) {
+        USART_DMA_RxComplete();
+    }
     DMA_ClearFlag(DMA1_Stream1, UART3_RX_DMA_ALL_FLAGS);
-    dma_flag = 1;
+    uart_rx_irq();
 }
 
 
+
 /* -------------------------------------------------------------------------------- */
 /* ------------------------------ Logging/Parameters ------------------------------ */
 /* -------------------------------------------------------------------------------- */
@@ -485,9 +1374,208 @@ void __attribute__((used)) DMA1_Stream1_IRQHandler(void)
 
 /* --------------- LOGGING --------------- */
 LOG_GROUP_START(DRONET_LOG)
-	LOG_ADD(LOG_FLOAT, fwd_vel, &forward_vel)  	// forward velocity
+	LOG_ADD(LOG_FLOAT, fwd_vel, &control.speed)  	// forward velocity command
+	LOG_ADD(LOG_FLOAT, yaw_rate, &control.yaw_rate) 	// [deg/s] yaw-rate command
+	LOG_ADD(LOG_FLOAT, ctrl_hz, &control_rate_hz) 	// control updates per second
+	LOG_ADD(LOG_UINT32, ctrl_lat, &control_lat_us) 	// [us] DMA interrupt -> control output
+	LOG_ADD(LOG_UINT32, ctrl_max, &control_lat_max)
+	LOG_ADD(LOG_FLOAT, steer, &cnn_data_float[CNN_STEERING]) 	// raw CNN outputs
+	LOG_ADD(LOG_FLOAT, coll, &cnn_data_float[CNN_COLLISION])
+	LOG_ADD(LOG_FLOAT, steer_f, &cnn_filtered[CNN_STEERING]) 	// filtered
+	LOG_ADD(LOG_FLOAT, coll_f, &cnn_filtered[CNN_COLLISION])
 LOG_GROUP_STOP(DRONET_LOG)
 
+LOG_GROUP_START(UART_LOG)
+	LOG_ADD(LOG_UINT32, frames, &uart_parser.stats.frames)  		// valid frames received
+	LOG_ADD(LOG_UINT32, crc_err, &uart_parser.stats.crc_errors)  	// frames dropped by the CRC check
+	LOG_ADD(LOG_UINT32, resyncs, &uart_parser.stats.resyncs)  		// sync word lost and found again
+	LOG_ADD(LOG_UINT32, dropped, &uart_parser.stats.bytes_dropped) // bytes discarded while resyncing
+	LOG_ADD(LOG_UINT32, seq_gaps, &uart_parser.stats.seq_gaps)  	// frames lost according to the sequence number
+	LOG_ADD(LOG_UINT32, torn, &usartDmaStats.torn)  				// reads overlapping with the DMA writing the same bytes
+	LOG_ADD(LOG_UINT32, rx_miss, &usartDmaStats.missed)  			// times the DMA lapped the parser, unread bytes lost
+	LOG_ADD(LOG_UINT32, q_drop, &inference_queue.overflows)  		// inference records dropped: queue full
+	LOG_ADD(LOG_UINT32, len_err, &inference_len_errors)  		// inference frames (any format) with a wrong payload size
+	LOG_ADD(LOG_UINT32, q_hwm, &inference_queue.high_water)  		// max inference queue depth
+	LOG_ADD(LOG_UINT32, baud, &uart_baudrate)  					// current baud rate
+	LOG_ADD(LOG_UINT32, baud_fb, &uart_baud.fallbacks)  			// fallbacks to the base baud rate
+	LOG_ADD(LOG_UINT32, err_pct, &uart_baud.last_error_pct)  		// [%] error ratio of the last window at high speed
+LOG_GROUP_STOP(UART_LOG)
+
+// Per-channel frame and payload byte counters
+LOG_GROUP_START(UART_CH)
+	LOG_ADD(LOG_UINT32, inf_fr, &uart_channel_stats[CH_INFERENCE].frames)
+	LOG_ADD(LOG_UINT32, inf_B, &uart_channel_stats[CH_INFERENCE].bytes)
+	LOG_ADD(LOG_UINT32, q8_fr, &uart_channel_stats[CH_INFERENCE_Q8].frames)
+	LOG_ADD(LOG_UINT32, q8_B, &uart_channel_stats[CH_INFERENCE_Q8].bytes)
+	LOG_ADD(LOG_UINT32, q16_fr, &uart_channel_stats[CH_INFERENCE_Q16].frames)
+	LOG_ADD(LOG_UINT32, q16_B, &uart_channel_stats[CH_INFERENCE_Q16].bytes)
+	LOG_ADD(LOG_UINT32, qhdr_fr, &uart_channel_stats[CH_QUANT].frames)
+	LOG_ADD(LOG_UINT32, qtab_fr, &uart_channel_stats[CH_QUANT_TABLE].frames)
+	LOG_ADD(LOG_UINT32, qtab_err, &quant_table_errors)
+	LOG_ADD(LOG_UINT32, baud_fr, &uart_channel_stats[CH_BAUD_ACK].frames)
+	LOG_ADD(LOG_UINT32, dbg_fr, &uart_channel_stats[CH_DEBUG_TEXT].frames)
+	LOG_ADD(LOG_UINT32, dbg_B, &uart_channel_stats[CH_DEBUG_TEXT].bytes)
+	LOG_ADD(LOG_UINT32, dbg_drop, &debug_text_dropped)
+	LOG_ADD(LOG_UINT32, cfg_fr, &uart_channel_stats[CH_CONFIG_ACK].frames)
+	LOG_ADD(LOG_UINT8, cfg_id, &config_ack_id)  					// last acknowledged config id
+	LOG_ADD(LOG_UINT8, cfg_stat, &config_ack_status)  			// and its status
+	LOG_ADD(LOG_UINT32, tim_fr, &uart_channel_stats[CH_TIMING].frames)
+	LOG_ADD(LOG_UINT32, unknown, &uart_dispatch.unknown)  		// frames with an unknown message id
+LOG_GROUP_STOP(UART_CH)
+
+// Per-stage latency of inference frames [us]: IRQ->decode, decode->post-processing, ->setpoint, IRQ->setpoint
+LOG_GROUP_START(TRACE)
+	LOG_ADD(LOG_FLOAT, dec_min, &latency_trace.stats[TRACE_STAGE_DECODE].min_us)
+	LOG_ADD(LOG_FLOAT, dec_avg, &latency_trace.stats[TRACE_STAGE_DECODE].mean_us)
+	LOG_ADD(LOG_FLOAT, dec_p99, &latency_trace.stats[TRACE_STAGE_DECODE].p99_us)
+	LOG_ADD(LOG_FLOAT, pp_min, &latency_trace.stats[TRACE_STAGE_POSTPROC].min_us)
+	LOG_ADD(LOG_FLOAT, pp_avg, &latency_trace.stats[TRACE_STAGE_POSTPROC].mean_us)
+	LOG_ADD(LOG_FLOAT, pp_p99, &latency_trace.stats[TRACE_STAGE_POSTPROC].p99_us)
+	LOG_ADD(LOG_FLOAT, sp_min, &latency_trace.stats[TRACE_STAGE_SETPOINT].min_us)
+	LOG_ADD(LOG_FLOAT, sp_avg, &latency_trace.stats[TRACE_STAGE_SETPOINT].mean_us)
+	LOG_ADD(LOG_FLOAT, sp_p99, &latency_trace.stats[TRACE_STAGE_SETPOINT].p99_us)
+	LOG_ADD(LOG_FLOAT, e2e_min, &latency_trace.stats[TRACE_STAGE_TOTAL].min_us)
+	LOG_ADD(LOG_FLOAT, e2e_avg, &latency_trace.stats[TRACE_STAGE_TOTAL].mean_us)
+	LOG_ADD(LOG_FLOAT, e2e_p99, &latency_trace.stats[TRACE_STAGE_TOTAL].p99_us)
+	LOG_ADD(LOG_UINT32, traces, &latency_trace.head)  			// completed traces
+LOG_GROUP_STOP(TRACE)
+
+// Health of the inference stream and failsafe level (0 ok, 1 slow, 2 hover, 3 land)
+LOG_GROUP_START(LINK)
+	LOG_ADD(LOG_FLOAT, rate, &link_health.rate_hz)  				// [Hz] inference frames
+	LOG_ADD(LOG_FLOAT, err_rate, &link_health.error_rate_hz)  	// [Hz] CRC errors, DMA laps, queue overflows
+	LOG_ADD(LOG_FLOAT, period, &link_health.period_us)  			// [us] smoothed inter-arrival time
+	LOG_ADD(LOG_FLOAT, jitter, &link_health.jitter_us)  			// [us]
+	LOG_ADD(LOG_UINT32, gap_max, &link_health.gap_max_us)  		// [us] longest gap between frames
+	LOG_ADD(LOG_UINT32, age, &link_age_ms)  						// [ms] since the last frame, updated in flight
+	LOG_ADD(LOG_UINT8, level, &link_watchdog.level)
+	LOG_ADD(LOG_UINT32, n_slow, &link_watchdog.trips[LINK_SLOW])
+	LOG_ADD(LOG_UINT32, n_hover, &link_watchdog.trips[LINK_HOVER])
+	LOG_ADD(LOG_UINT32, n_land, &link_watchdog.trips[LINK_LAND])
+LOG_GROUP_STOP(LINK)
+
+// Post-processing kernels [cycles/element]: SIMD (or portable) build vs C reference, measured at boot
+LOG_GROUP_START(QPOST)
+	LOG_ADD(LOG_UINT32, mismatch, &qpost_bench.mismatches)  		// must be 0: bit-exact with the reference
+	LOG_ADD(LOG_FLOAT, dq_cpe, &qpost_bench.cpe[QPOST_K_DEQUANT])
+	LOG_ADD(LOG_FLOAT, dq_ref, &qpost_bench.cpe_ref[QPOST_K_DEQUANT])
+	LOG_ADD(LOG_FLOAT, cl_cpe, &qpost_bench.cpe[QPOST_K_CLAMP])
+	LOG_ADD(LOG_FLOAT, cl_ref, &qpost_bench.cpe_ref[QPOST_K_CLAMP])
+	LOG_ADD(LOG_FLOAT, sc_cpe, &qpost_bench.cpe[QPOST_K_SCALE])
+	LOG_ADD(LOG_FLOAT, sc_ref, &qpost_bench.cpe_ref[QPOST_K_SCALE])
+	LOG_ADD(LOG_FLOAT, am_cpe, &qpost_bench.cpe[QPOST_K_ARGMAX])
+	LOG_ADD(LOG_FLOAT, am_ref, &qpost_bench.cpe_ref[QPOST_K_ARGMAX])
+	LOG_ADD(LOG_FLOAT, pl_cpe, &qpost_bench.cpe[QPOST_K_POOL])
+	LOG_ADD(LOG_FLOAT, pl_ref, &qpost_bench.cpe_ref[QPOST_K_POOL])
+LOG_GROUP_STOP(QPOST)
+
+// Streamed output tensors
+LOG_GROUP_START(TENSOR)
+	LOG_ADD(LOG_UINT32, chunks, &tensor_rx[TENSOR_DEPTH].stats.chunks)
+	LOG_ADD(LOG_UINT32, tensors, &tensor_rx[TENSOR_DEPTH].stats.tensors)
+	LOG_ADD(LOG_UINT32, rows, &tensor_rx[TENSOR_DEPTH].stats.rows)
+	LOG_ADD(LOG_UINT32, dropped, &tensor_rx[TENSOR_DEPTH].stats.dropped)  	// tensors with a missing chunk
+	LOG_ADD(LOG_UINT32, skipped, &tensor_rows_skipped)  					// rows the app task fell behind on
+	LOG_ADD(LOG_INT8, depth_min, &depth_min)  							// closest value of the last depth grid
+	LOG_ADD(LOG_FLOAT, near_m, &depth_near)  							// [m] and in meters
+LOG_GROUP_STOP(TENSOR)
+
+// Takeoff and landing durations
+LOG_GROUP_START(TRAJ)
+	LOG_ADD(LOG_UINT32, to_ms, &takeoff_ms) 		// [ms] climb + hold of the last takeoff
+	LOG_ADD(LOG_UINT8, to_tmo, &takeoff_timeout) 	// the hold hit TRAJ_SETTLE_TIMEOUT_MS
+	LOG_ADD(LOG_UINT32, land_ms, &landing_ms) 	// [ms] descent + hold of the last landing
+	LOG_ADD(LOG_UINT8, land_tmo, &landing_timeout) 	// the hold hit TRAJ_LANDING_TIMEOUT_MS
+LOG_GROUP_STOP(TRAJ)
+
+// Cost of the last spin manouver
+LOG_GROUP_START(SPIN)
+	LOG_ADD(LOG_UINT32, ms, &spin_ms)
+	LOG_ADD(LOG_UINT32, writes, &spin_writes) 	// setpoints written by the app task
+	LOG_ADD(LOG_UINT32, cycles, &spin_cycles)
+LOG_GROUP_STOP(SPIN)
+
+LOG_GROUP_START(STATE_REG)
+	LOG_ADD(LOG_UINT8, missing, &state_missing) 	// log/param variables not found
+	LOG_ADD(LOG_UINT32, name_min, &state_bench_min[STATE_BENCH_NAME]) 	// [cycles] yaw read by name
+	LOG_ADD(LOG_UINT32, name_avg, &state_bench_mean[STATE_BENCH_NAME])
+	LOG_ADD(LOG_UINT32, id_min, &state_bench_min[STATE_BENCH_ID]) 		// [cycles] yaw read by cached id
+	LOG_ADD(LOG_UINT32, id_avg, &state_bench_mean[STATE_BENCH_ID])
+	LOG_ADD(LOG_UINT32, snap_min, &state_bench_min[STATE_BENCH_SNAP]) 	// [cycles] full snapshot
+	LOG_ADD(LOG_UINT32, snap_avg, &state_bench_mean[STATE_BENCH_SNAP])
+LOG_GROUP_STOP(STATE_REG)
+
+// Manoeuvre executor
+LOG_GROUP_START(MANEUVER)
+	LOG_ADD(LOG_UINT8, active, &maneuvers.id) 		// running manoeuvre, 0 = none
+	LOG_ADD(LOG_UINT32, started, &maneuvers.started)
+	LOG_ADD(LOG_UINT32, done, &maneuvers.completed)
+	LOG_ADD(LOG_UINT32, preempt, &maneuvers.preempted) 	// aborted by the failsafe or a landing
+	LOG_ADD(LOG_UINT32, step_max, &maneuver_step_max) 	// [cycles] longest step
+LOG_GROUP_STOP(MANEUVER)
+
+LOG_GROUP_START(PATH)
+	LOG_ADD(LOG_FLOAT, length, &path.length) 		// [m] one lap of the last path
+	LOG_ADD(LOG_UINT32, build_us, &path_build_us)
+LOG_GROUP_STOP(PATH)
+
+// Setpoint streaming, actual against SETPOINT/rate requested
+LOG_GROUP_START(SETPOINT)
+	LOG_ADD(LOG_FLOAT, rate_hz, &setpoint_health.rate_hz) 	// setpoints sent per second, 0 when idle
+	LOG_ADD(LOG_FLOAT, period, &setpoint_health.period_us) 	// [us] smoothed
+	LOG_ADD(LOG_FLOAT, jitter, &setpoint_health.jitter_us) 	// [us]
+	LOG_ADD(LOG_UINT32, gap_max, &setpoint_health.gap_max_us) 	// [us] longest interval, idle periods included
+	LOG_ADD(LOG_UINT32, sent, &setpoint_health.frames)
+	LOG_ADD(LOG_UINT32, retries, &setpoint_buffer.retries) 	// buffer reads redone
+LOG_GROUP_STOP(SETPOINT)
+
+// Fused input of the control law (source 0 is DroNet, 1.. the UART_MSG_NET_COMMAND networks)
+LOG_GROUP_START(FUSION)
+	LOG_ADD(LOG_FLOAT, steer, &fused.command.steering)
+	LOG_ADD(LOG_FLOAT, speed, &fused.command.speed) 	// fraction of the maximum speed
+	LOG_ADD(LOG_FLOAT, conf, &fused.command.confidence)
+	LOG_ADD(LOG_UINT8, valid, &fused.valid)
+	LOG_ADD(LOG_UINT8, used, &fused.used) 			// bit mask of the sources used at the last tick
+	LOG_ADD(LOG_UINT32, age_max, &fused.age_max_us) 	// [us] oldest result used
+	LOG_ADD(LOG_UINT32, invalid, &fusion.invalid) 	// ticks without a fresh DroNet result
+	LOG_ADD(LOG_UINT32, rej0, &fusion.rejected[0]) 	// stale results, per source
+	LOG_ADD(LOG_UINT32, rej1, &fusion.rejected[1])
+	LOG_ADD(LOG_UINT32, rej2, &fusion.rejected[2])
+	LOG_ADD(LOG_UINT32, rej3, &fusion.rejected[3])
+	LOG_ADD(LOG_UINT32, net_err, &net_command_errors)
+LOG_GROUP_STOP(FUSION)
+
+// Dequantization in use and quantization overflows, per CNN output
+LOG_GROUP_START(QUANT_LOG)
+	LOG_ADD(LOG_FLOAT, st_scale, &quant_table[CNN_STEERING].scale)
+	LOG_ADD(LOG_INT32, st_zero, &quant_table[CNN_STEERING].zero_point)
+	LOG_ADD(LOG_UINT32, st_sat, &quant_saturated[CNN_STEERING]) 	// values at the limit of the wire type
+	LOG_ADD(LOG_FLOAT, col_scale, &quant_table[CNN_COLLISION].scale)
+	LOG_ADD(LOG_INT32, col_zero, &quant_table[CNN_COLLISION].zero_point)
+	LOG_ADD(LOG_UINT32, col_sat, &quant_saturated[CNN_COLLISION])
+LOG_GROUP_STOP(QUANT_LOG)
+
+LOG_GROUP_START(UART_TX)
+	LOG_ADD(LOG_UINT32, depth, &uart_tx.depth)  					// [byte] queued + in flight
+	LOG_ADD(LOG_UINT32, Bps, &uart_tx.bytes_per_sec)  			// [byte/s] sent over the last second
+	LOG_ADD(LOG_UINT32, frames, &uart_tx.frames_queued)
+	LOG_ADD(LOG_UINT32, dropped, &uart_tx.frames_dropped)  		// TX batch full
+LOG_GROUP_STOP(UART_TX)
+
+// DMA interrupt -> app task latency histogram, each bin is named after its upper edge
+LOG_GROUP_START(UART_LAT)
+	LOG_ADD(LOG_UINT32, h16us, &latency_hist[0])
+	LOG_ADD(LOG_UINT32, h64us, &latency_hist[1])
+	LOG_ADD(LOG_UINT32, h256us, &latency_hist[2])
+	LOG_ADD(LOG_UINT32, h1ms, &latency_hist[3])
+	LOG_ADD(LOG_UINT32, h4ms, &latency_hist[4])
+	LOG_ADD(LOG_UINT32, h16ms, &latency_hist[5])
+	LOG_ADD(LOG_UINT32, h65ms, &latency_hist[6])
+	LOG_ADD(LOG_UINT32, h_inf, &latency_hist[7])
+	LOG_ADD(LOG_UINT32, last_us, &latency_last)
+	LOG_ADD(LOG_UINT32, max_us, &latency_max)
+LOG_GROUP_STOP(UART_LAT)
+
 /* --------------- PARAMETERS --------------- */
 PARAM_GROUP_START(START_STOP)
 	PARAM_ADD(PARAM_UINT8, fly, &fly)
@@ -499,15 +1587,118 @@ PARAM_GROUP_STOP(DEBUG)
 
 // Activate - deactivate functionalities: 0=Non-active, 1=active
 PARAM_GROUP_START(MANOUVERS)
-	PARAM_ADD(PARAM_UINT8, circle, &circle) 				// fly in circle
+	PARAM_ADD(PARAM_UINT8, circle, &circle) 				// fly the PATH parameters' path
 	PARAM_ADD(PARAM_UINT8, spin_t_c, &spin_drone) 			// spin in place with a fixed time
 	PARAM_ADD(PARAM_UINT8, spin_yr_c, &spin_drone_yr) 		// spin in place with a fixed yaw rate
 	PARAM_ADD(PARAM_UINT8, spin_rand, &spin_drone_random) 	// spin in place randomly
 PARAM_GROUP_STOP(MANOUVERS)
 
+// Path flown by MANOUVERS.circle (path.h)
+PARAM_GROUP_START(PATH)
+	PARAM_ADD(PARAM_UINT8, type, &path_type) 		// 0 circle, 1 figure-8, 2 lemniscate, 3 polygon, 4 spline
+	PARAM_ADD(PARAM_FLOAT, size, &path_size) 		// [m] radius or half-width
+	PARAM_ADD(PARAM_FLOAT, speed, &path_speed) 		// [m/s]
+	PARAM_ADD(PARAM_UINT8, sides, &path_sides) 		// polygon
+	PARAM_ADD(PARAM_UINT8, laps, &path_laps)
+PARAM_GROUP_STOP(PATH)
+
+PARAM_GROUP_START(UART_PAR)
+	PARAM_ADD(PARAM_UINT16, st_rate, &state_rate) 	// [Hz] state snapshots sent to the AI-deck, 0 = off
+PARAM_GROUP_STOP(UART_PAR)
+
+// Failsafe on a silent AI-deck link, times since the last inference frame
+PARAM_GROUP_START(WATCHDOG)
+	PARAM_ADD(PARAM_UINT8, enable, &wd_enable)
+	PARAM_ADD(PARAM_UINT32, slow_ms, &link_watchdog.config.slow_ms)
+	PARAM_ADD(PARAM_UINT32, hover_ms, &link_watchdog.config.hover_ms)
+	PARAM_ADD(PARAM_UINT32, land_ms, &link_watchdog.config.land_ms)
+	PARAM_ADD(PARAM_FLOAT, slow_k, &wd_slow_factor) 	// forward speed multiplier while slowed down
+PARAM_GROUP_STOP(WATCHDOG)
+
+// Dequantization of each CNN output, overwritten by the next UART_MSG_QUANT_TABLE/HEADER from the AI-deck
+PARAM_GROUP_START(QUANT_PAR)
+	PARAM_ADD(PARAM_FLOAT, st_scale, &quant_table[CNN_STEERING].scale)
+	PARAM_ADD(PARAM_INT32, st_zero, &quant_table[CNN_STEERING].zero_point)
+	PARAM_ADD(PARAM_FLOAT, col_scale, &quant_table[CNN_COLLISION].scale)
+	PARAM_ADD(PARAM_INT32, col_zero, &quant_table[CNN_COLLISION].zero_point)
+PARAM_GROUP_STOP(QUANT_PAR)
+
+// Takeoff and landing trajectories (trajectory.h)
+PARAM_GROUP_START(TRAJ)
+	PARAM_ADD(PARAM_FLOAT, v_up, &traj_takeoff_vel) 	// [m/s] peak climb speed
+	PARAM_ADD(PARAM_FLOAT, v_down, &traj_landing_vel) 	// [m/s] peak descent speed
+	PARAM_ADD(PARAM_FLOAT, acc, &traj_max_acc) 		// [m/s^2] climb
+	PARAM_ADD(PARAM_FLOAT, acc_down, &traj_landing_acc) 	// [m/s^2] descent
+	PARAM_ADD(PARAM_FLOAT, st_tol, &traj_settle_config.tolerance) 	// [m] height error ending the hold
+	PARAM_ADD(PARAM_FLOAT, st_speed, &traj_settle_config.speed_tolerance) 	// [m/s]
+	PARAM_ADD(PARAM_UINT32, st_ms, &traj_settle_config.settle_ms)
+	PARAM_ADD(PARAM_UINT32, st_tmo_ms, &traj_settle_config.timeout_ms)
+	PARAM_ADD(PARAM_FLOAT, ld_tol, &traj_landing_config.tolerance) 	// [m] height error ending the landing hold
+	PARAM_ADD(PARAM_FLOAT, ld_speed, &traj_landing_config.speed_tolerance) 	// [m/s]
+	PARAM_ADD(PARAM_UINT32, ld_ms, &traj_landing_config.settle_ms)
+	PARAM_ADD(PARAM_UINT32, ld_tmo_ms, &traj_landing_config.timeout_ms)
+PARAM_GROUP_STOP(TRAJ)
+
+PARAM_GROUP_START(SETPOINT)
+	PARAM_ADD(PARAM_UINT16, rate, &setpoint_rate) 	// [Hz] setpoints streamed to the commander
+PARAM_GROUP_STOP(SETPOINT)
+
+// Fusion sources: enable, required, steering weight, max age [us]
+PARAM_GROUP_START(FUSION)
+	PARAM_ADD(PARAM_UINT8, en0, &fusion.config[0].enable)
+	PARAM_ADD(PARAM_UINT8, req0, &fusion.config[0].required)
+	PARAM_ADD(PARAM_FLOAT, w0, &fusion.config[0].weight)
+	PARAM_ADD(PARAM_UINT32, age0_us, &fusion.config[0].max_age_us)
+	PARAM_ADD(PARAM_UINT8, en1, &fusion.config[1].enable)
+	PARAM_ADD(PARAM_UINT8, req1, &fusion.config[1].required)
+	PARAM_ADD(PARAM_FLOAT, w1, &fusion.config[1].weight)
+	PARAM_ADD(PARAM_UINT32, age1_us, &fusion.config[1].max_age_us)
+	PARAM_ADD(PARAM_UINT8, en2, &fusion.config[2].enable)
+	PARAM_ADD(PARAM_UINT8, req2, &fusion.config[2].required)
+	PARAM_ADD(PARAM_FLOAT, w2, &fusion.config[2].weight)
+	PARAM_ADD(PARAM_UINT32, age2_us, &fusion.config[2].max_age_us)
+	PARAM_ADD(PARAM_UINT8, en3, &fusion.config[3].enable)
+	PARAM_ADD(PARAM_UINT8, req3, &fusion.config[3].required)
+	PARAM_ADD(PARAM_FLOAT, w3, &fusion.config[3].weight)
+	PARAM_ADD(PARAM_UINT32, age3_us, &fusion.config[3].max_age_us)
+PARAM_GROUP_STOP(FUSION)
+
+// DroNet control law (dronet_control.h), the maximum speed is PARAMETERS/velocity
+PARAM_GROUP_START(CONTROL)
+	PARAM_ADD(PARAM_UINT8, enable, &control_enable)
+	PARAM_ADD(PARAM_FLOAT, max_yawr, &control_config.max_yaw_rate) 	// [deg/s]
+	PARAM_ADD(PARAM_FLOAT, db_steer, &control_config.steer_deadband)
+	PARAM_ADD(PARAM_FLOAT, db_coll, &control_config.coll_deadband)
+	PARAM_ADD(PARAM_FLOAT, a_speed, &control_config.alpha_speed)
+	PARAM_ADD(PARAM_FLOAT, a_yaw, &control_config.alpha_yaw)
+PARAM_GROUP_STOP(CONTROL)
+
+// Temporal filters of the CNN outputs (filter_bank.h)
+PARAM_GROUP_START(FILT_ST)
+	PARAM_ADD(PARAM_UINT8, type, &filter_config[CNN_STEERING].type) 	// 0 none, 1 EMA, 2 median, 3 1-euro, 4 Kalman
+	PARAM_ADD(PARAM_FLOAT, alpha, &filter_config[CNN_STEERING].alpha)
+	PARAM_ADD(PARAM_UINT8, median_n, &filter_config[CNN_STEERING].median_n)
+	PARAM_ADD(PARAM_FLOAT, fc_min, &filter_config[CNN_STEERING].min_cutoff)
+	PARAM_ADD(PARAM_FLOAT, beta, &filter_config[CNN_STEERING].beta)
+	PARAM_ADD(PARAM_FLOAT, fc_d, &filter_config[CNN_STEERING].d_cutoff)
+	PARAM_ADD(PARAM_FLOAT, kf_q, &filter_config[CNN_STEERING].q)
+	PARAM_ADD(PARAM_FLOAT, kf_r, &filter_config[CNN_STEERING].r)
+PARAM_GROUP_STOP(FILT_ST)
+
+PARAM_GROUP_START(FILT_COL)
+	PARAM_ADD(PARAM_UINT8, type, &filter_config[CNN_COLLISION].type) 	// 0 none, 1 EMA, 2 median, 3 1-euro, 4 Kalman
+	PARAM_ADD(PARAM_FLOAT, alpha, &filter_config[CNN_COLLISION].alpha)
+	PARAM_ADD(PARAM_UINT8, median_n, &filter_config[CNN_COLLISION].median_n)
+	PARAM_ADD(PARAM_FLOAT, fc_min, &filter_config[CNN_COLLISION].min_cutoff)
+	PARAM_ADD(PARAM_FLOAT, beta, &filter_config[CNN_COLLISION].beta)
+	PARAM_ADD(PARAM_FLOAT, fc_d, &filter_config[CNN_COLLISION].d_cutoff)
+	PARAM_ADD(PARAM_FLOAT, kf_q, &filter_config[CNN_COLLISION].q)
+	PARAM_ADD(PARAM_FLOAT, kf_r, &filter_config[CNN_COLLISION].r)
+PARAM_GROUP_STOP(FILT_COL)
+
 // Filters' parameters
 PARAM_GROUP_START(PARAMETERS)
-	PARAM_ADD(PARAM_FLOAT, velocity, &forward_vel)
+	PARAM_ADD(PARAM_FLOAT, velocity, &control_config.max_speed) 	// [m/s] forward speed with no collision
 	PARAM_ADD(PARAM_FLOAT, height, &flying_height)
 	PARAM_ADD(PARAM_FLOAT, spin_ang, &spin_angle)
 	PARAM_ADD(PARAM_FLOAT, spin_time, &spin_time)
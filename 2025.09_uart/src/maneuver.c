@@ -0,0 +1,67 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    maneuver.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "maneuver.h"
+
+void maneuver_executor_init(maneuver_executor_t *executor)
+{
+  memset(executor, 0, sizeof(maneuver_executor_t));
+}
+
+bool maneuver_start(maneuver_executor_t *executor, uint8_t id, maneuver_step_t step, void *ctx, uint32_t now_ms)
+{
+  if (executor->id != 0 || id == 0 || step == NULL) {
+    return false;
+  }
+  executor->current = (maneuver_t){ .step = step, .ctx = ctx, .line = 0, .start_ms = now_ms };
+  executor->id = id;
+  executor->steps = 0;
+  executor->started++;
+  return true;
+}
+
+void maneuver_abort(maneuver_executor_t *executor)
+{
+  if (executor->id != 0) {
+    executor->id = 0;
+    executor->preempted++;
+  }
+}
+
+bool maneuver_active(const maneuver_executor_t *executor)
+{
+  return executor->id != 0;
+}
+
+bool maneuver_tick(maneuver_executor_t *executor, uint32_t now_ms)
+{
+  if (executor->id == 0) {
+    return false;
+  }
+  executor->steps++;
+  if (executor->current.step(&executor->current, now_ms) == MANEUVER_DONE) {
+    executor->id = 0;
+    executor->completed++;
+  }
+  return true;
+}
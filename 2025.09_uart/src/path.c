@@ -0,0 +1,241 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    path.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <string.h>
+#include "path.h"
+
+#define PATH_TWO_PI         6.28318530718f
+#define PATH_RENORM_EVERY   16    // rotation steps between two renormalizations of the unit vector
+
+// Walks one shape along its own parameter, one point per call, in order
+typedef struct {
+  const path_config_t *config;
+  uint32_t steps;         // points are 0 .. steps
+  float c, s;             // unit vector at the current angle
+  float cd, sd;           // rotation applied after every point
+  uint32_t edge;          // polygon: edge of the current point
+  float v0[2], v1[2];     // polygon: vertices of that edge
+} path_gen_t;
+
+static void gen_rotate(float *c, float *s, float cd, float sd)
+{
+  float c1 = *c * cd - *s * sd;
+  *s = *s * cd + *c * sd;
+  *c = c1;
+}
+
+static void gen_reset(path_gen_t *gen, const path_config_t *config)
+{
+  memset(gen, 0, sizeof(path_gen_t));
+  gen->config = config;
+  gen->steps = PATH_BUILD_STEPS;
+  gen->c = 1.0f;
+  float delta = PATH_TWO_PI / PATH_BUILD_STEPS;
+  if (config->type == PATH_POLYGON) {
+    gen->steps -= PATH_BUILD_STEPS % config->sides;  // every edge gets the same number of steps
+    delta = PATH_TWO_PI / config->sides;
+    gen->v0[0] = config->size;
+    gen->v1[0] = config->size * cosf(delta);
+    gen->v1[1] = config->size * sinf(delta);
+  }
+  gen->cd = cosf(delta);
+  gen->sd = sinf(delta);
+}
+
+static uint32_t spline_index(const path_config_t *config, int32_t i)
+{
+  int32_t n = config->n_waypoints;
+  if (config->closed) return (uint32_t)((i % n + n) % n);
+  if (i < 0) return 0;
+  if (i >= n) return (uint32_t)(n - 1);
+  return (uint32_t)i;
+}
+
+// Uniform Catmull-Rom through the waypoints, shifted so the first one is the origin
+static void gen_spline(const path_config_t *config, uint32_t i, uint32_t steps, float *x, float *y)
+{
+  uint32_t segments = config->closed ? config->n_waypoints : config->n_waypoints - 1u;
+  uint32_t k = i * segments / steps;
+  float t = (float)(i * segments - k * steps) / (float)steps;
+  if (k == segments) {
+    k = segments - 1u;
+    t = 1.0f;
+  }
+  const float *p0 = config->waypoints[spline_index(config, (int32_t)k - 1)];
+  const float *p1 = config->waypoints[spline_index(config, (int32_t)k)];
+  const float *p2 = config->waypoints[spline_index(config, (int32_t)k + 1)];
+  const float *p3 = config->waypoints[spline_index(config, (int32_t)k + 2)];
+  float t2 = t * t;
+  float t3 = t2 * t;
+  float out[2];
+  for (int a = 0; a < 2; a++) {
+    out[a] = 0.5f * (2.0f * p1[a] + (p2[a] - p0[a]) * t
+                     + (2.0f * p0[a] - 5.0f * p1[a] + 4.0f * p2[a] - p3[a]) * t2
+                     + (3.0f * (p1[a] - p2[a]) + p3[a] - p0[a]) * t3);
+  }
+  *x = out[0] - config->waypoints[0][0];
+  *y = out[1] - config->waypoints[0][1];
+}
+
+// Point i of the walk; must be called for i = 0, 1, .. steps
+static void gen_next(path_gen_t *gen, uint32_t i, float *x, float *y)
+{
+  const path_config_t *config = gen->config;
+  float r = config->size;
+  float c = gen->c;
+  float s = gen->s;
+  switch (config->type) {
+    case PATH_CIRCLE:
+      *x = r * (c - 1.0f);
+      *y = r * s;
+      break;
+    case PATH_FIGURE8:
+      *x = r * s;
+      *y = r * s * c;
+      break;
+    case PATH_LEMNISCATE: {
+      float d = 1.0f / (1.0f + s * s);
+      *x = r * (c * d - 1.0f);
+      *y = r * s * c * d;
+      break;
+    }
+    case PATH_POLYGON: {
+      uint32_t per_edge = gen->steps / config->sides;
+      uint32_t edge = i / per_edge;
+      if (edge >= config->sides) edge = config->sides - 1u;  // last point closes the last edge
+      while (gen->edge < edge) {
+        gen->v0[0] = gen->v1[0];
+        gen->v0[1] = gen->v1[1];
+        gen_rotate(&gen->v1[0], &gen->v1[1], gen->cd, gen->sd);
+        gen->edge++;
+      }
+      float t = (float)(i - edge * per_edge) / (float)per_edge;
+      *x = gen->v0[0] + (gen->v1[0] - gen->v0[0]) * t - r;
+      *y = gen->v0[1] + (gen->v1[1] - gen->v0[1]) * t;
+      return;
+    }
+    default:
+      gen_spline(config, i, gen->steps, x, y);
+      return;
+  }
+  gen_rotate(&gen->c, &gen->s, gen->cd, gen->sd);
+  if ((i + 1u) % PATH_RENORM_EVERY == 0) {
+    // first-order correction of the rounding that accumulates in the rotation
+    float k = 1.5f - 0.5f * (gen->c * gen->c + gen->s * gen->s);
+    gen->c *= k;
+    gen->s *= k;
+  }
+}
+
+static bool config_valid(const path_config_t *config)
+{
+  switch (config->type) {
+    case PATH_CIRCLE:
+    case PATH_FIGURE8:
+    case PATH_LEMNISCATE:
+      return config->size > 0.0f;
+    case PATH_POLYGON:
+      return config->size > 0.0f && config->sides >= 3;
+    case PATH_SPLINE:
+      return config->n_waypoints <= PATH_MAX_WAYPOINTS && config->n_waypoints >= (config->closed ? 3 : 2);
+    default:
+      return false;
+  }
+}
+
+bool path_init(path_t *path, const path_config_t *config)
+{
+  memset(path, 0, sizeof(path_t));
+  if (!config_valid(config)) {
+    return false;
+  }
+  path_gen_t gen;
+  float x, y, px, py;
+
+  // pass 1: length of the polyline through the build points
+  float length = 0.0f;
+  gen_reset(&gen, config);
+  gen_next(&gen, 0, &px, &py);
+  for (uint32_t i = 1; i <= gen.steps; i++) {
+    gen_next(&gen, i, &x, &y);
+    length += sqrtf((x - px) * (x - px) + (y - py) * (y - py));
+    px = x;
+    py = y;
+  }
+  if (!(length > 0.0f)) {
+    return false;
+  }
+  path->length = length;
+  path->step = length / PATH_TABLE_SIZE;
+  path->inv_step = PATH_TABLE_SIZE / length;
+  path->closed = config->type != PATH_SPLINE || config->closed;
+
+  // pass 2: the same walk, with a table point every "step" meters
+  uint32_t k = 1;
+  float walked = 0.0f;
+  gen_reset(&gen, config);
+  gen_next(&gen, 0, &px, &py);
+  path->table[0][0] = px;
+  path->table[0][1] = py;
+  for (uint32_t i = 1; i <= gen.steps; i++) {
+    gen_next(&gen, i, &x, &y);
+    float d = sqrtf((x - px) * (x - px) + (y - py) * (y - py));
+    while (k < PATH_TABLE_SIZE && walked + d >= k * path->step) {
+      float t = (k * path->step - walked) / d;
+      path->table[k][0] = px + (x - px) * t;
+      path->table[k][1] = py + (y - py) * t;
+      k++;
+    }
+    walked += d;
+    px = x;
+    py = y;
+  }
+  // the end point is exact, whatever the rounding of the walk
+  for (; k <= PATH_TABLE_SIZE; k++) {
+    path->table[k][0] = path->closed ? path->table[0][0] : px;
+    path->table[k][1] = path->closed ? path->table[0][1] : py;
+  }
+  return true;
+}
+
+void path_sample(const path_t *path, float s, float *x, float *y, float *tx, float *ty)
+{
+  float f = s * path->inv_step;
+  if (path->closed) {
+    f -= (float)(int32_t)(f * (1.0f / PATH_TABLE_SIZE)) * PATH_TABLE_SIZE;
+    if (f < 0.0f) f += PATH_TABLE_SIZE;
+  } else if (f < 0.0f) {
+    f = 0.0f;
+  } else if (f > PATH_TABLE_SIZE) {
+    f = PATH_TABLE_SIZE;
+  }
+  int32_t k = (int32_t)f;
+  if (k >= PATH_TABLE_SIZE) k = PATH_TABLE_SIZE - 1;
+  float t = f - (float)k;
+  const float *a = path->table[k];
+  const float *b = path->table[k + 1];
+  *x = a[0] + (b[0] - a[0]) * t;
+  *y = a[1] + (b[1] - a[1]) * t;
+  if (tx) *tx = (b[0] - a[0]) * path->inv_step;
+  if (ty) *ty = (b[1] - a[1]) * path->inv_step;
+}
@@ -0,0 +1,350 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    qpost.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "qpost.h"
+#if QPOST_SIMD
+#include "stm32f4xx.h"  // CMSIS SIMD intrinsics
+#endif
+
+#define DUP16(x)  (((uint32_t)(uint16_t)(x)) * 0x00010001u)  // same int16 in both lanes
+
+static inline int16_t sat16(int32_t x)
+{
+  if (x > INT16_MAX) return INT16_MAX;
+  if (x < INT16_MIN) return INT16_MIN;
+  return (int16_t)x;
+}
+
+qpost_scale_t qpost_scale_from_float(float scale, uint8_t frac_bits)
+{
+  qpost_scale_t result = { 0, 0 };
+  float target = scale;
+  for (uint8_t i = 0; i < frac_bits; i++) target *= 2.0f;
+
+  // largest shift that keeps the multiplier in int16, for the best precision
+  float magnitude = target < 0 ? -target : target;
+  if (magnitude == 0.0f) {
+    return result;
+  }
+  while (result.shift < 31 && magnitude * 2.0f <= (float)INT16_MAX) {
+    magnitude *= 2.0f;
+    target *= 2.0f;
+    result.shift++;
+  }
+  if (target > (float)INT16_MAX) target = (float)INT16_MAX;
+  if (target < (float)-INT16_MAX) target = (float)-INT16_MAX;
+  result.mult = (int16_t)(target + (target >= 0 ? 0.5f : -0.5f));
+  return result;
+}
+
+/* --------------- Reference (portable C) --------------- */
+
+void qpost_ref_dequant_s8(const int8_t *in, int16_t *out, uint32_t n, int16_t zero_point, qpost_scale_t scale)
+{
+  for (uint32_t i = 0; i < n; i++) {
+    out[i] = sat16(((int32_t)sat16(in[i] - zero_point) * scale.mult) >> scale.shift);
+  }
+}
+
+void qpost_ref_clamp_s16(int16_t *data, uint32_t n, int16_t lo, int16_t hi)
+{
+  for (uint32_t i = 0; i < n; i++) {
+    if (data[i] < lo) data[i] = lo;
+    if (data[i] > hi) data[i] = hi;
+  }
+}
+
+void qpost_ref_scale_s16(int16_t *data, uint32_t n, qpost_scale_t scale)
+{
+  for (uint32_t i = 0; i < n; i++) {
+    data[i] = sat16(((int32_t)data[i] * scale.mult) >> scale.shift);
+  }
+}
+
+uint32_t qpost_ref_argmax_s16(const int16_t *data, uint32_t n)
+{
+  uint32_t index = 0;
+  for (uint32_t i = 1; i < n; i++) {
+    if (data[i] > data[index]) index = i;
+  }
+  return index;
+}
+
+void qpost_ref_pool_s8(const int8_t *in, int8_t *out, uint16_t rows, uint16_t cols,
+                       uint16_t win_rows, uint16_t win_cols, qpost_pool_t mode)
+{
+  if (win_rows == 0 || win_cols == 0) return;
+  uint16_t out_rows = rows / win_rows;
+  uint16_t out_cols = cols / win_cols;
+
+  for (uint16_t orow = 0; orow < out_rows; orow++) {
+    for (uint16_t ocol = 0; ocol < out_cols; ocol++) {
+      const int8_t *window = &in[orow * win_rows * cols + ocol * win_cols];
+      int8_t value = window[0];
+      for (uint16_t r = 0; r < win_rows; r++) {
+        for (uint16_t c = 0; c < win_cols; c++) {
+          int8_t x = window[r * cols + c];
+          if (mode == QPOST_POOL_MAX ? x > value : x < value) value = x;
+        }
+      }
+      out[orow * out_cols + ocol] = value;
+    }
+  }
+}
+
+/* --------------- Public kernels: M4 SIMD when available --------------- */
+
+#if QPOST_SIMD
+
+void qpost_dequant_s8(const int8_t *in, int16_t *out, uint32_t n, int16_t zero_point, qpost_scale_t scale)
+{
+  uint32_t zp = DUP16(zero_point);
+  uint32_t mult = (uint16_t)scale.mult;  // bottom lane only: SMUAD picks the bottom product, SMUADX the top one
+  uint32_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    uint32_t w;
+    memcpy(&w, &in[i], sizeof(w));
+    uint32_t even = __QSUB16(__SXTB16(w), zp);          // in[i], in[i+2], saturated like the reference
+    uint32_t odd = __QSUB16(__SXTB16(__ROR(w, 8)), zp); // in[i+1], in[i+3]
+    out[i]     = (int16_t)__SSAT((int32_t)__SMUAD(even, mult) >> scale.shift, 16);
+    out[i + 1] = (int16_t)__SSAT((int32_t)__SMUAD(odd, mult) >> scale.shift, 16);
+    out[i + 2] = (int16_t)__SSAT((int32_t)__SMUADX(even, mult) >> scale.shift, 16);
+    out[i + 3] = (int16_t)__SSAT((int32_t)__SMUADX(odd, mult) >> scale.shift, 16);
+  }
+  qpost_ref_dequant_s8(&in[i], &out[i], n - i, zero_point, scale);
+}
+
+void qpost_clamp_s16(int16_t *data, uint32_t n, int16_t lo, int16_t hi)
+{
+  uint32_t lo2 = DUP16(lo), hi2 = DUP16(hi);
+  uint32_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    uint32_t x;
+    memcpy(&x, &data[i], sizeof(x));
+    __SSUB16(x, lo2);       // GE flags: x >= lo, per lane
+    x = __SEL(x, lo2);
+    __SSUB16(hi2, x);       // GE flags: hi >= x
+    x = __SEL(x, hi2);
+    memcpy(&data[i], &x, sizeof(x));
+  }
+  qpost_ref_clamp_s16(&data[i], n - i, lo, hi);
+}
+
+void qpost_scale_s16(int16_t *data, uint32_t n, qpost_scale_t scale)
+{
+  uint32_t mult = (uint16_t)scale.mult;
+  uint32_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    uint32_t x;
+    memcpy(&x, &data[i], sizeof(x));
+    int32_t bottom = __SSAT((int32_t)__SMUAD(x, mult) >> scale.shift, 16);
+    int32_t top = __SSAT((int32_t)__SMUADX(x, mult) >> scale.shift, 16);
+    x = __PKHBT(bottom, top, 16);
+    memcpy(&data[i], &x, sizeof(x));
+  }
+  qpost_ref_scale_s16(&data[i], n - i, scale);
+}
+
+uint32_t qpost_argmax_s16(const int16_t *data, uint32_t n)
+{
+  if (n == 0) return 0;
+  // largest value two lanes at a time, then the first index holding it
+  uint32_t max2 = DUP16(data[0]);
+  uint32_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    uint32_t x;
+    memcpy(&x, &data[i], sizeof(x));
+    __SSUB16(x, max2);
+    max2 = __SEL(x, max2);
+  }
+  int16_t best = (int16_t)max2;
+  if ((int16_t)(max2 >> 16) > best) best = (int16_t)(max2 >> 16);
+  for (; i < n; i++) {
+    if (data[i] > best) best = data[i];
+  }
+  for (i = 0; data[i] != best; i++);
+  return i;
+}
+
+void qpost_pool_s8(const int8_t *in, int8_t *out, uint16_t rows, uint16_t cols,
+                   uint16_t win_rows, uint16_t win_cols, qpost_pool_t mode)
+{
+  if (win_rows == 0 || win_cols == 0 || cols > QPOST_POOL_MAX_COLS) {
+    qpost_ref_pool_s8(in, out, rows, cols, win_rows, win_cols, mode);
+    return;
+  }
+  uint16_t out_rows = rows / win_rows;
+  uint16_t out_cols = cols / win_cols;
+  uint32_t used = out_cols * win_cols;
+  int8_t acc[QPOST_POOL_MAX_COLS];
+
+  for (uint16_t orow = 0; orow < out_rows; orow++) {
+    // vertical pass, four columns per word
+    const int8_t *row = &in[orow * win_rows * cols];
+    memcpy(acc, row, used);
+    for (uint16_t r = 1; r < win_rows; r++) {
+      const int8_t *next = &row[r * cols];
+      uint32_t c = 0;
+      for (; c + 4 <= used; c += 4) {
+        uint32_t a, x;
+        memcpy(&a, &acc[c], sizeof(a));
+        memcpy(&x, &next[c], sizeof(x));
+        if (mode == QPOST_POOL_MAX) __SSUB8(x, a);  // GE flags: x >= acc, per lane
+        else __SSUB8(a, x);                         // GE flags: acc >= x
+        a = __SEL(x, a);
+        memcpy(&acc[c], &a, sizeof(a));
+      }
+      for (; c < used; c++) {
+        if (mode == QPOST_POOL_MAX ? next[c] > acc[c] : next[c] < acc[c]) acc[c] = next[c];
+      }
+    }
+    // horizontal pass over each window
+    for (uint16_t ocol = 0; ocol < out_cols; ocol++) {
+      const int8_t *window = &acc[ocol * win_cols];
+      int8_t value = window[0];
+      for (uint16_t c = 1; c < win_cols; c++) {
+        if (mode == QPOST_POOL_MAX ? window[c] > value : window[c] < value) value = window[c];
+      }
+      out[orow * out_cols + ocol] = value;
+    }
+  }
+}
+
+#else
+
+void qpost_dequant_s8(const int8_t *in, int16_t *out, uint32_t n, int16_t zero_point, qpost_scale_t scale)
+{
+  qpost_ref_dequant_s8(in, out, n, zero_point, scale);
+}
+
+void qpost_clamp_s16(int16_t *data, uint32_t n, int16_t lo, int16_t hi)
+{
+  qpost_ref_clamp_s16(data, n, lo, hi);
+}
+
+void qpost_scale_s16(int16_t *data, uint32_t n, qpost_scale_t scale)
+{
+  qpost_ref_scale_s16(data, n, scale);
+}
+
+uint32_t qpost_argmax_s16(const int16_t *data, uint32_t n)
+{
+  return qpost_ref_argmax_s16(data, n);
+}
+
+void qpost_pool_s8(const int8_t *in, int8_t *out, uint16_t rows, uint16_t cols,
+                   uint16_t win_rows, uint16_t win_cols, qpost_pool_t mode)
+{
+  qpost_ref_pool_s8(in, out, rows, cols, win_rows, win_cols, mode);
+}
+
+#endif
+
+/* --------------- Self-test and benchmark --------------- */
+
+#define TEST_N        127   // odd, to exercise the scalar tails
+#define TEST_ROWS     16
+#define TEST_COLS     30    // not a multiple of 4
+#define TEST_WIN_ROWS 2
+#define TEST_WIN_COLS 3
+#define TEST_POOLED   ((TEST_ROWS / TEST_WIN_ROWS) * (TEST_COLS / TEST_WIN_COLS))
+
+static int8_t test_in[TEST_ROWS * TEST_COLS];
+static int16_t test_a[TEST_N], test_b[TEST_N];
+static int8_t test_pool_a[TEST_POOLED], test_pool_b[TEST_POOLED];
+
+static uint32_t count_diff16(const int16_t *a, const int16_t *b, uint32_t n)
+{
+  uint32_t diff = 0;
+  for (uint32_t i = 0; i < n; i++) diff += a[i] != b[i];
+  return diff;
+}
+
+static uint32_t count_diff8(const int8_t *a, const int8_t *b, uint32_t n)
+{
+  uint32_t diff = 0;
+  for (uint32_t i = 0; i < n; i++) diff += a[i] != b[i];
+  return diff;
+}
+
+static uint32_t no_cycles(void)
+{
+  return 0;
+}
+
+uint32_t qpost_selftest(qpost_bench_t *bench, uint32_t (*cycles)(void))
+{
+  memset(bench, 0, sizeof(qpost_bench_t));
+  if (cycles == NULL) cycles = no_cycles;
+
+  uint32_t seed = 12345;
+  for (uint32_t i = 0; i < sizeof(test_in); i++) {
+    seed = seed * 1664525u + 1013904223u;  // LCG
+    test_in[i] = (int8_t)(seed >> 24);
+  }
+  qpost_scale_t dequant = qpost_scale_from_float(0.0006f, QPOST_FRAC_BITS);
+  qpost_scale_t gain = qpost_scale_from_float(3.7f, 8);  // overflows on purpose: checks the saturation
+  uint32_t t0, t1;
+
+  t0 = cycles(); qpost_dequant_s8(test_in, test_a, TEST_N, -3, dequant); t1 = cycles();
+  bench->cpe[QPOST_K_DEQUANT] = (float)(t1 - t0) / TEST_N;
+  t0 = cycles(); qpost_ref_dequant_s8(test_in, test_b, TEST_N, -3, dequant); t1 = cycles();
+  bench->cpe_ref[QPOST_K_DEQUANT] = (float)(t1 - t0) / TEST_N;
+  bench->mismatches += count_diff16(test_a, test_b, TEST_N);
+  // zero points far enough out that in - zero_point leaves int16: checks that both paths saturate it
+  qpost_dequant_s8(test_in, test_a, TEST_N, INT16_MIN, dequant);
+  qpost_ref_dequant_s8(test_in, test_b, TEST_N, INT16_MIN, dequant);
+  bench->mismatches += count_diff16(test_a, test_b, TEST_N);
+  qpost_dequant_s8(test_in, test_a, TEST_N, INT16_MAX, dequant);
+  qpost_ref_dequant_s8(test_in, test_b, TEST_N, INT16_MAX, dequant);
+  bench->mismatches += count_diff16(test_a, test_b, TEST_N);
+
+  // the same int16 input for the in-place kernels: the int8 data scaled up to the full range
+  for (uint32_t i = 0; i < TEST_N; i++) test_a[i] = test_b[i] = (int16_t)(test_in[i] * 256 + test_in[i + 1]);
+  t0 = cycles(); qpost_scale_s16(test_a, TEST_N, gain); t1 = cycles();
+  bench->cpe[QPOST_K_SCALE] = (float)(t1 - t0) / TEST_N;
+  t0 = cycles(); qpost_ref_scale_s16(test_b, TEST_N, gain); t1 = cycles();
+  bench->cpe_ref[QPOST_K_SCALE] = (float)(t1 - t0) / TEST_N;
+  bench->mismatches += count_diff16(test_a, test_b, TEST_N);
+
+  t0 = cycles(); qpost_clamp_s16(test_a, TEST_N, -1000, 20000); t1 = cycles();
+  bench->cpe[QPOST_K_CLAMP] = (float)(t1 - t0) / TEST_N;
+  t0 = cycles(); qpost_ref_clamp_s16(test_b, TEST_N, -1000, 20000); t1 = cycles();
+  bench->cpe_ref[QPOST_K_CLAMP] = (float)(t1 - t0) / TEST_N;
+  bench->mismatches += count_diff16(test_a, test_b, TEST_N);
+
+  t0 = cycles(); uint32_t index_a = qpost_argmax_s16(test_a, TEST_N); t1 = cycles();
+  bench->cpe[QPOST_K_ARGMAX] = (float)(t1 - t0) / TEST_N;
+  t0 = cycles(); uint32_t index_b = qpost_ref_argmax_s16(test_b, TEST_N); t1 = cycles();
+  bench->cpe_ref[QPOST_K_ARGMAX] = (float)(t1 - t0) / TEST_N;
+  bench->mismatches += index_a != index_b;
+
+  for (int mode = QPOST_POOL_MAX; mode <= QPOST_POOL_MIN; mode++) {
+    t0 = cycles(); qpost_pool_s8(test_in, test_pool_a, TEST_ROWS, TEST_COLS, TEST_WIN_ROWS, TEST_WIN_COLS, mode); t1 = cycles();
+    bench->cpe[QPOST_K_POOL] += (float)(t1 - t0) / (2 * sizeof(test_in));
+    t0 = cycles(); qpost_ref_pool_s8(test_in, test_pool_b, TEST_ROWS, TEST_COLS, TEST_WIN_ROWS, TEST_WIN_COLS, mode); t1 = cycles();
+    bench->cpe_ref[QPOST_K_POOL] += (float)(t1 - t0) / (2 * sizeof(test_in));
+    bench->mismatches += count_diff8(test_pool_a, test_pool_b, TEST_POOLED);
+  }
+  return bench->mismatches;
+}
@@ -0,0 +1,55 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    setpoint_buffer.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "setpoint_buffer.h"
+
+void setpoint_buffer_init(setpoint_buffer_t *buffer)
+{
+  memset(buffer, 0, sizeof(setpoint_buffer_t));
+}
+
+void setpoint_buffer_write(setpoint_buffer_t *buffer, const setpoint_request_t *request)
+{
+  uint32_t seq = buffer->started + 1;
+  // announce the slot before touching it, so a reader still copying it can tell
+  __atomic_store_n(&buffer->started, seq, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  buffer->slots[seq & 1] = *request;
+  __atomic_store_n(&buffer->seq, seq, __ATOMIC_RELEASE);
+}
+
+uint32_t setpoint_buffer_read(setpoint_buffer_t *buffer, setpoint_request_t *request)
+{
+  uint32_t seq = __atomic_load_n(&buffer->seq, __ATOMIC_ACQUIRE);
+  for (int i = 0; i < SETPOINT_READ_RETRIES; i++) {
+    *request = buffer->slots[seq & 1];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    // the next write goes to the other slot, the one after it to this one
+    if (__atomic_load_n(&buffer->started, __ATOMIC_RELAXED) - seq < 2) {
+      return seq;
+    }
+    buffer->retries++;
+    seq = __atomic_load_n(&buffer->seq, __ATOMIC_ACQUIRE);
+  }
+  return seq;
+}
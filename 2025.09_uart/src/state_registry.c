@@ -0,0 +1,108 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    state_registry.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include "log.h"
+#include "param.h"
+#include "usec_time.h"
+#include "state_registry.h"
+
+typedef struct {
+  const char *group;
+  const char *name;
+} state_var_name_t;
+
+static const state_var_name_t log_names[STATE_N_LOGS] = {
+  [STATE_X]           = { "stateEstimate", "x" },
+  [STATE_Y]           = { "stateEstimate", "y" },
+  [STATE_Z]           = { "stateEstimate", "z" },
+  [STATE_VX]          = { "stateEstimate", "vx" },
+  [STATE_VY]          = { "stateEstimate", "vy" },
+  [STATE_VZ]          = { "stateEstimate", "vz" },
+  [STATE_ROLL]        = { "stateEstimate", "roll" },
+  [STATE_PITCH]       = { "stateEstimate", "pitch" },
+  [STATE_YAW]         = { "stateEstimate", "yaw" },
+  [STATE_RANGE_FRONT] = { "range", "front" },
+  [STATE_RANGE_BACK]  = { "range", "back" },
+  [STATE_RANGE_LEFT]  = { "range", "left" },
+  [STATE_RANGE_RIGHT] = { "range", "right" },
+  [STATE_RANGE_UP]    = { "range", "up" },
+};
+
+static const state_var_name_t param_names[STATE_N_PARAMS] = {
+  [STATE_DECK_FLOW]        = { "deck", "bcFlow2" },
+  [STATE_DECK_MULTIRANGER] = { "deck", "bcMultiranger" },
+};
+
+static logVarId_t log_ids[STATE_N_LOGS];
+static paramVarId_t param_ids[STATE_N_PARAMS];
+static bool log_valid[STATE_N_LOGS];
+static bool param_valid[STATE_N_PARAMS];
+
+uint8_t state_registry_init(void)
+{
+  uint8_t missing = 0;
+  for (int i = 0; i < STATE_N_LOGS; i++) {
+    log_ids[i] = logGetVarId(log_names[i].group, log_names[i].name);
+    log_valid[i] = logVarIdIsValid(log_ids[i]);
+    missing += !log_valid[i];
+  }
+  for (int i = 0; i < STATE_N_PARAMS; i++) {
+    param_ids[i] = paramGetVarId(param_names[i].group, param_names[i].name);
+    param_valid[i] = paramVarIdIsValid(param_ids[i]);
+    missing += !param_valid[i];
+  }
+  return missing;
+}
+
+float state_get_float(state_log_t var)
+{
+  return log_valid[var] ? logGetFloat(log_ids[var]) : 0.0f;
+}
+
+uint32_t state_get_uint(state_log_t var)
+{
+  return log_valid[var] ? logGetUint(log_ids[var]) : 0;
+}
+
+uint32_t state_param_uint(state_param_t var)
+{
+  return param_valid[var] ? paramGetUint(param_ids[var]) : 0;
+}
+
+void state_snapshot(state_snapshot_t *snapshot)
+{
+  snapshot->timestamp = usecTimestamp();
+  snapshot->x = state_get_float(STATE_X);
+  snapshot->y = state_get_float(STATE_Y);
+  snapshot->z = state_get_float(STATE_Z);
+  snapshot->vx = state_get_float(STATE_VX);
+  snapshot->vy = state_get_float(STATE_VY);
+  snapshot->vz = state_get_float(STATE_VZ);
+  snapshot->roll = state_get_float(STATE_ROLL);
+  snapshot->pitch = state_get_float(STATE_PITCH);
+  snapshot->yaw = state_get_float(STATE_YAW);
+  snapshot->range_front = (uint16_t)state_get_uint(STATE_RANGE_FRONT);
+  snapshot->range_back = (uint16_t)state_get_uint(STATE_RANGE_BACK);
+  snapshot->range_left = (uint16_t)state_get_uint(STATE_RANGE_LEFT);
+  snapshot->range_right = (uint16_t)state_get_uint(STATE_RANGE_RIGHT);
+  snapshot->range_up = (uint16_t)state_get_uint(STATE_RANGE_UP);
+}
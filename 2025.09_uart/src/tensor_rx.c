@@ -0,0 +1,111 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    tensor_rx.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "tensor_rx.h"
+
+// progress word: | valid (1 bit) | slot (7 bits) | frame (8 bits) | rows (16 bits) |
+#define PROGRESS(slot, frame, rows) (0x80000000u | ((uint32_t)(slot) << 24) | ((uint32_t)(frame) << 16) | (rows))
+
+void tensor_rx_init(tensor_rx_t *rx, const tensor_schema_t *schema, uint8_t *arena,
+                    tensor_row_handler_t on_row, void *ctx)
+{
+  memset(rx, 0, sizeof(tensor_rx_t));
+  rx->schema = schema;
+  rx->arena = arena;
+  rx->row_size = TENSOR_BYTES(1, schema->cols, schema->elem_size);
+  rx->size = rx->row_size * schema->rows;
+  rx->on_row = on_row;
+  rx->ctx = ctx;
+}
+
+static void publish(tensor_rx_t *rx, uint16_t rows)
+{
+  // the row bytes must be visible before the consumer sees the new count
+  __atomic_store_n(&rx->progress, PROGRESS(rx->slot, rx->frame, rows), __ATOMIC_RELEASE);
+}
+
+bool tensor_rx_chunk(tensor_rx_t *rx, uint8_t frame, uint16_t offset, const uint8_t *data, uint32_t len)
+{
+  if (offset == 0) {
+    if (rx->receiving) {
+      rx->stats.dropped++;  // previous tensor never completed
+    }
+    rx->receiving = true;
+    rx->slot ^= 1;  // the previous tensor, complete or not, stays readable in the other half
+    rx->frame = frame;
+    rx->offset = 0;
+  } else if (!rx->receiving || frame != rx->frame || offset != rx->offset) {
+    // count each abandoned tensor once, including one whose first chunk was lost
+    if (rx->receiving || frame != rx->frame) {
+      rx->stats.dropped++;
+    }
+    rx->receiving = false;
+    rx->frame = frame;
+    return false;
+  }
+  if (rx->offset + len > rx->size) {
+    rx->receiving = false;
+    rx->stats.overruns++;
+    rx->stats.dropped++;
+    return false;
+  }
+
+  uint16_t rows_before = (uint16_t)(rx->offset / rx->row_size);
+  memcpy(&rx->arena[rx->slot * rx->size + rx->offset], data, len);
+  rx->offset += len;
+  rx->stats.chunks++;
+
+  uint16_t rows = (uint16_t)(rx->offset / rx->row_size);
+  if (rows == rows_before) {
+    return true;
+  }
+  publish(rx, rows);
+  rx->stats.rows += rows - rows_before;
+  if (rx->on_row) {
+    for (uint16_t row = rows_before; row < rows; row++) {
+      rx->on_row(rx, row, rx->ctx);
+    }
+  }
+  if (rx->offset == rx->size) {
+    rx->stats.tensors++;
+    rx->receiving = false;
+  }
+  return true;
+}
+
+bool tensor_rx_progress(const tensor_rx_t *rx, uint8_t *slot, uint8_t *frame, uint16_t *rows)
+{
+  uint32_t progress = __atomic_load_n(&rx->progress, __ATOMIC_ACQUIRE);
+  if (!(progress & 0x80000000u)) {
+    return false;
+  }
+  *slot = (uint8_t)((progress >> 24) & 0x7F);
+  *frame = (uint8_t)(progress >> 16);
+  *rows = (uint16_t)progress;
+  return true;
+}
+
+const uint8_t *tensor_rx_row(const tensor_rx_t *rx, uint8_t slot, uint16_t row)
+{
+  return &rx->arena[slot * rx->size + row * rx->row_size];
+}
@@ -0,0 +1,118 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    trajectory.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <string.h>
+#include "trajectory.h"
+
+void traj_segment_init(traj_segment_t *segment, float p0, float p1, float v_max, float a_max)
+{
+  float distance = fabsf(p1 - p0);
+  float duration = 0.0f;
+  if (v_max > 0.0f) {
+    duration = TRAJ_MJ_PEAK_VEL * distance / v_max;
+  }
+  if (a_max > 0.0f) {
+    float t_acc = sqrtf(TRAJ_MJ_PEAK_ACC * distance / a_max);
+    if (t_acc > duration) duration = t_acc;
+  }
+  segment->p0 = p0;
+  segment->delta = p1 - p0;
+  segment->duration = duration;
+  segment->inv_duration = duration > 0.0f ? 1.0f / duration : 0.0f;
+  segment->profile = TRAJ_MIN_JERK;
+}
+
+void traj_segment_init_timed(traj_segment_t *segment, float p0, float p1, float duration, traj_profile_t profile)
+{
+  if (!(duration > 0.0f)) duration = 0.0f;
+  segment->p0 = p0;
+  segment->delta = p1 - p0;
+  segment->duration = duration;
+  segment->inv_duration = duration > 0.0f ? 1.0f / duration : 0.0f;
+  segment->profile = profile;
+}
+
+float traj_segment_sample(const traj_segment_t *segment, float t, float *vel, float *acc)
+{
+  if (t >= segment->duration || segment->duration <= 0.0f) {
+    if (vel) *vel = 0.0f;
+    if (acc) *acc = 0.0f;
+    return segment->p0 + segment->delta;
+  }
+  if (t <= 0.0f) {
+    if (vel) *vel = 0.0f;
+    if (acc) *acc = 0.0f;
+    return segment->p0;
+  }
+  float u = t * segment->inv_duration;
+  if (segment->profile == TRAJ_LINEAR) {
+    if (vel) *vel = segment->delta * segment->inv_duration;
+    if (acc) *acc = 0.0f;
+    return segment->p0 + segment->delta * u;
+  }
+  float u2 = u * u;
+  // s = 10u^3 - 15u^4 + 6u^5, s' = 30u^2 (1 - u)^2, s'' = 60u (1 - u)(1 - 2u)
+  float s = u2 * u * (10.0f + u * (-15.0f + 6.0f * u));
+  if (vel) {
+    float w = 1.0f - u;
+    *vel = segment->delta * segment->inv_duration * 30.0f * u2 * w * w;
+  }
+  if (acc) {
+    *acc = segment->delta * segment->inv_duration * segment->inv_duration * 60.0f * u * (1.0f - u) * (1.0f - 2.0f * u);
+  }
+  return segment->p0 + segment->delta * s;
+}
+
+float traj_wrap_deg(float deg)
+{
+  if (deg >= 180.0f || deg < -180.0f) {
+    deg -= 360.0f * (float)(int32_t)(deg * (1.0f / 360.0f));  // now within (-360, 360)
+    if (deg >= 180.0f) deg -= 360.0f;
+    if (deg < -180.0f) deg += 360.0f;
+  }
+  return deg;
+}
+
+void traj_settle_start(traj_settle_t *settle, uint32_t now_ms)
+{
+  memset(settle, 0, sizeof(traj_settle_t));
+  settle->start_ms = now_ms;
+}
+
+bool traj_settle_update(traj_settle_t *settle, const traj_settle_config_t *config, float error, float speed,
+                        uint32_t now_ms)
+{
+  if (now_ms - settle->start_ms >= config->timeout_ms) {
+    settle->timed_out = true;
+    return true;
+  }
+  if (fabsf(error) > config->tolerance || fabsf(speed) > config->speed_tolerance) {
+    settle->inside = false;
+    return false;
+  }
+  if (!settle->inside) {
+    settle->inside = true;
+    settle->inside_ms = now_ms;
+  }
+  return now_ms - settle->inside_ms >= config->settle_ms;
+}
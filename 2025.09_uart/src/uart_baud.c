@@ -0,0 +1,131 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_baud.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "uart_baud.h"
+
+static void baud_set_state(uart_baud_t *neg, uart_baud_state_t state, uint32_t now_ms,
+                           uint32_t frames, uint32_t errors)
+{
+  neg->state = state;
+  neg->t_state = now_ms;
+  neg->t_keepalive = now_ms;
+  neg->window_frames = frames;
+  neg->window_errors = errors;
+}
+
+static void baud_apply(uart_baud_t *neg, uint32_t baud)
+{
+  neg->baud = baud;
+  neg->io.apply(baud, neg->io.ctx);
+}
+
+// Give up on the current candidate and go back to the base rate
+static void baud_fallback(uart_baud_t *neg, uint32_t now_ms, uint32_t frames, uint32_t errors)
+{
+  if (neg->baud != UART_BAUD_BASE) {
+    // best effort: tell the AI-deck, it also reverts on its own when the heartbeats stop
+    neg->io.send_request(UART_BAUD_BASE, neg->io.ctx);
+    baud_apply(neg, UART_BAUD_BASE);
+    neg->fallbacks++;
+  }
+  if (neg->candidate < UART_BAUD_MAX_RATES) {
+    neg->candidate++;
+  }
+  baud_set_state(neg, UART_BAUD_STATE_BASE, now_ms, frames, errors);
+}
+
+void uart_baud_init(uart_baud_t *neg, const uart_baud_config_t *config, const uart_baud_io_t *io)
+{
+  memset(neg, 0, sizeof(uart_baud_t));
+  neg->config = *config;
+  neg->io = *io;
+  neg->baud = UART_BAUD_BASE;
+  neg->state = UART_BAUD_STATE_BASE;
+}
+
+void uart_baud_step(uart_baud_t *neg, uint32_t now_ms, uint32_t frames, uint32_t errors)
+{
+  const uart_baud_config_t *cfg = &neg->config;
+  uint32_t elapsed = now_ms - neg->t_state;
+
+  switch (neg->state) {
+    case UART_BAUD_STATE_BASE:
+      if (elapsed < cfg->holdoff_ms) break;
+      // all candidates failed: start over from the fastest one
+      if (neg->candidate >= UART_BAUD_MAX_RATES || cfg->rates[neg->candidate] == 0) {
+        neg->candidate = 0;
+      }
+      if (cfg->rates[neg->candidate] == 0) break;
+      neg->io.send_request(cfg->rates[neg->candidate], neg->io.ctx);
+      baud_set_state(neg, UART_BAUD_STATE_REQUESTED, now_ms, frames, errors);
+      break;
+
+    case UART_BAUD_STATE_REQUESTED:
+      if (elapsed >= cfg->ack_timeout_ms) {
+        baud_fallback(neg, now_ms, frames, errors);
+      }
+      break;
+
+    case UART_BAUD_STATE_PROBATION:
+    case UART_BAUD_STATE_ACTIVE: {
+      if (now_ms - neg->t_keepalive >= cfg->keepalive_ms) {
+        neg->io.send_request(neg->baud, neg->io.ctx);
+        neg->t_keepalive = now_ms;
+      }
+      if (elapsed < cfg->window_ms) break;
+
+      uint32_t window_frames = frames - neg->window_frames;
+      uint32_t window_errors = errors - neg->window_errors;
+      uint32_t total = window_frames + window_errors;
+      neg->last_error_pct = total ? (100 * window_errors) / total : 0;
+
+      if (neg->last_error_pct > cfg->max_error_pct && total > 0) {
+        baud_fallback(neg, now_ms, frames, errors);
+      }
+      else if (neg->state == UART_BAUD_STATE_PROBATION && window_frames < cfg->min_frames) {
+        // nothing decodable arrived at the new rate
+        baud_fallback(neg, now_ms, frames, errors);
+      }
+      else {
+        uint32_t t_keepalive = neg->t_keepalive;
+        baud_set_state(neg, UART_BAUD_STATE_ACTIVE, now_ms, frames, errors);
+        neg->t_keepalive = t_keepalive;
+      }
+      break;
+    }
+  }
+}
+
+void uart_baud_on_ack(uart_baud_t *neg, uint32_t baud, uint32_t now_ms, uint32_t frames, uint32_t errors)
+{
+  if (neg->state != UART_BAUD_STATE_REQUESTED) return;  // heartbeat echo
+
+  if (baud == 0 || baud != neg->config.rates[neg->candidate]) {
+    // refused by the AI-deck: try the next rate right away
+    baud_fallback(neg, now_ms, frames, errors);
+    neg->t_state = now_ms - neg->config.holdoff_ms;
+    return;
+  }
+  baud_apply(neg, baud);
+  baud_set_state(neg, UART_BAUD_STATE_PROBATION, now_ms, frames, errors);
+}
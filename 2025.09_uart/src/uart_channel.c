@@ -0,0 +1,57 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_channel.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "uart_channel.h"
+
+void uart_dispatch_init(uart_dispatch_t *dispatch, const uart_channel_t *channels,
+                        uart_channel_stats_t *stats, uint8_t n_channels, void *ctx)
+{
+  dispatch->channels = channels;
+  dispatch->stats = stats;
+  dispatch->n_channels = n_channels;
+  dispatch->unknown = 0;
+  dispatch->ctx = ctx;
+  memset(stats, 0, n_channels * sizeof(uart_channel_stats_t));
+}
+
+void uart_channel_dispatch(const uart_frame_t *frame, void *ctx)
+{
+  uart_dispatch_t *dispatch = (uart_dispatch_t *)ctx;
+
+  // a handful of channels: a linear scan of the const table is cheaper than a 256-entry lookup
+  for (uint8_t i = 0; i < dispatch->n_channels; i++) {
+    const uart_channel_t *channel = &dispatch->channels[i];
+    if (channel->msg_id != frame->msg_id) continue;
+
+    uart_channel_stats_t *stats = &dispatch->stats[i];
+    if (frame->len < channel->min_len || frame->len > channel->max_len) {
+      stats->len_errors++;
+      return;
+    }
+    stats->frames++;
+    stats->bytes += frame->len;
+    channel->handler(frame, dispatch->ctx);
+    return;
+  }
+  dispatch->unknown++;
+}
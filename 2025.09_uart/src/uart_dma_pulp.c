@@ -20,38 +20,96 @@
  Date:    01.03.2024
 -------------------------------------------------------------------------------*/
 
+#include <stddef.h>
 #include "uart_dma_pulp.h"
+#include "uart_dma_setup.h"
+#include "nvicconf.h"
 
 DMA_InitTypeDef  DMA_InitStructure;
+USART_DMA_Stats usartDmaStats;
 
-static void USART_Config(uint32_t baudrate, int8_t *pulpRxBuffer, uint32_t BUFFERSIZE);
+// circular mode: one RX ring, rxBuffers[0]
+// double-buffer mode: rxBuffers[0] on memory target 0, rxBuffers[1] on memory target 1,
+// read as a ring of two segments. Either way the reader follows the DMA write position
+// byte by byte, so frames need not line up with the buffers.
+static int8_t *rxBuffers[2];
+static uint32_t rxBufferSize;
+static uint8_t rxDoubleBuffer;
+static uint8_t rxReadSeg;            // segment and offset of the next byte to read
+static uint32_t rxReadPos;
+static uint32_t rxTotalRead;
+static volatile uint32_t rxGen;      // DMA transfers completed: ring laps or filled buffers
+static uint8_t txStarted;            // a TX transfer ran since the TC flag was cleared
 
-void USART_DMA_Start(uint32_t baudrate, int8_t *pulpRxBuffer, uint32_t BUFFERSIZE)
-{
-  // Setup Communication
-  USART_Config(baudrate, pulpRxBuffer, BUFFERSIZE);
+static void USART_Config(uint32_t baudrate, int8_t *rxBuffer0, int8_t *rxBuffer1, uint32_t BUFFERSIZE);
+static void USART_Setup(uint32_t baudrate);
 
+static void USART_DMA_Enable(void)
+{
   DMA_ITConfig(USARTx_RX_DMA_STREAM, DMA_IT_TC, ENABLE);
+  // circular mode: also interrupt when the first half of the ring is full
+  if (!rxDoubleBuffer) {
+    DMA_ITConfig(USARTx_RX_DMA_STREAM, DMA_IT_HT, ENABLE);
+  }
 
   // Enable DMA USART RX Stream
   DMA_Cmd(USARTx_RX_DMA_STREAM,ENABLE);
 
-  // Enable USART DMA RX Requsts
-  USART_DMACmd(USARTx, USART_DMAReq_Rx, ENABLE);
+  // Enable USART DMA RX and TX Requsts
+  USART_DMACmd(USARTx, USART_DMAReq_Rx | USART_DMAReq_Tx, ENABLE);
 
   // Clear DMA Transfer Complete Flags
   DMA_ClearFlag(USARTx_RX_DMA_STREAM,USARTx_RX_DMA_FLAG_TCIF);
 
   // Clear USART Transfer Complete Flags
   USART_ClearFlag(USARTx,USART_FLAG_TC);
+  txStarted = 0;
 
   DMA_ClearFlag(USARTx_RX_DMA_STREAM, UART3_RX_DMA_ALL_FLAGS);
-  NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+
+  // Below configMAX_SYSCALL_INTERRUPT_PRIORITY so the handler may wake the app task
+  NVIC_InitTypeDef NVIC_InitStructure;
+  NVIC_InitStructure.NVIC_IRQChannel = USARTx_DMA_RX_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_MID_PRI;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
 }
 
-static void USART_Config(uint32_t baudrate, int8_t *pulpRxBuffer, uint32_t BUFFERSIZE)
+void USART_DMA_Start(uint32_t baudrate, int8_t *pulpRxBuffer, uint32_t BUFFERSIZE)
+{
+  rxBuffers[0] = pulpRxBuffer;
+  rxBuffers[1] = NULL;
+  rxBufferSize = BUFFERSIZE;
+  rxDoubleBuffer = 0;
+  rxReadSeg = 0;
+  rxReadPos = 0;
+  rxTotalRead = 0;
+  rxGen = 0;
+
+  // Setup Communication
+  USART_Config(baudrate, pulpRxBuffer, NULL, BUFFERSIZE);
+  USART_DMA_Enable();
+}
+
+void USART_DMA_StartDoubleBuffer(uint32_t baudrate, int8_t *pulpRxBuffer0, int8_t *pulpRxBuffer1, uint32_t BUFFERSIZE)
+{
+  rxBuffers[0] = pulpRxBuffer0;
+  rxBuffers[1] = pulpRxBuffer1;
+  rxBufferSize = BUFFERSIZE;
+  rxDoubleBuffer = 1;
+  rxReadSeg = 0;
+  rxReadPos = 0;
+  rxTotalRead = 0;
+  rxGen = 0;
+
+  // Setup Communication
+  USART_Config(baudrate, pulpRxBuffer0, pulpRxBuffer1, BUFFERSIZE);
+  USART_DMA_Enable();
+}
+
+static void USART_Config(uint32_t baudrate, int8_t *rxBuffer0, int8_t *rxBuffer1, uint32_t BUFFERSIZE)
 {
-    USART_InitTypeDef USART_InitStructure;
     GPIO_InitTypeDef GPIO_InitStructure;
 
     // Enable GPIO clock
@@ -80,16 +138,7 @@ static void USART_Config(uint32_t baudrate, int8_t *pulpRxBuffer, uint32_t BUFFE
     GPIO_Init(USARTx_RX_GPIO_PORT, &GPIO_InitStructure);
 
     // USARTx configuration
-    USART_OverSampling8Cmd(USARTx, ENABLE);
-
-    USART_InitStructure.USART_BaudRate = baudrate;
-    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
-    USART_InitStructure.USART_StopBits = USART_StopBits_1;
-    /* When using Parity the word length must be configured to 9 bits */
-    USART_InitStructure.USART_Parity = USART_Parity_No;
-    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
-    USART_InitStructure.USART_Mode = USART_Mode_Rx;
-    USART_Init(USARTx, &USART_InitStructure);
+    USART_Setup(baudrate);
 
     /* Configure DMA Initialization Structure */
     DMA_InitStructure.DMA_BufferSize = BUFFERSIZE ;
@@ -108,9 +157,156 @@ static void USART_Config(uint32_t baudrate, int8_t *pulpRxBuffer, uint32_t BUFFE
     /* Configure RX DMA */
     DMA_InitStructure.DMA_Channel = USARTx_RX_DMA_CHANNEL ;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory ;
-    DMA_InitStructure.DMA_Memory0BaseAddr =(uint32_t)pulpRxBuffer ;
+    DMA_InitStructure.DMA_Memory0BaseAddr =(uint32_t)rxBuffer0 ;
     DMA_Init(USARTx_RX_DMA_STREAM,&DMA_InitStructure);
 
+    /* Double-buffer mode: the stream swaps between memory 0 and memory 1 at every transfer complete */
+    if (rxBuffer1 != NULL) {
+      DMA_DoubleBufferModeConfig(USARTx_RX_DMA_STREAM, (uint32_t)rxBuffer1, DMA_Memory_0);
+      DMA_DoubleBufferModeCmd(USARTx_RX_DMA_STREAM, ENABLE);
+    }
+
+    /* Configure TX DMA: one-shot transfers started by USART_DMA_Send() */
+    DMA_InitStructure.DMA_BufferSize = 1;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_Channel = USARTx_TX_DMA_CHANNEL ;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral ;
+    DMA_Init(USARTx_TX_DMA_STREAM,&DMA_InitStructure);
+
     /* Enable USART */
     USART_Cmd(USARTx, ENABLE);
 }
+
+static void USART_Setup(uint32_t baudrate)
+{
+    USART_InitTypeDef USART_InitStructure;
+
+    // 8x oversampling: up to 42 MHz / 8 = 5.25 Mbaud on APB1. 1, 2 and 3 Mbaud are exact.
+    USART_OverSampling8Cmd(USARTx, ENABLE);
+
+    USART_InitStructure.USART_BaudRate = baudrate;
+    USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+    USART_InitStructure.USART_StopBits = USART_StopBits_1;
+    /* When using Parity the word length must be configured to 9 bits */
+    USART_InitStructure.USART_Parity = USART_Parity_No;
+    USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+    USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+    USART_Init(USARTx, &USART_InitStructure);
+}
+
+uint8_t USART_DMA_TxBusy(void)
+{
+  // the stream disables itself at the end of a normal-mode transfer
+  return DMA_GetCmdStatus(USARTx_TX_DMA_STREAM) == ENABLE;
+}
+
+TestStatus USART_DMA_Send(const uint8_t *data, uint32_t len)
+{
+  if (USART_DMA_TxBusy()) return FAILED;
+
+  DMA_ClearFlag(USARTx_TX_DMA_STREAM, USARTx_TX_DMA_FLAG_FEIF | USARTx_TX_DMA_FLAG_DMEIF |
+                USARTx_TX_DMA_FLAG_TEIF | USARTx_TX_DMA_FLAG_HTIF | USARTx_TX_DMA_FLAG_TCIF);
+  DMA_MemoryTargetConfig(USARTx_TX_DMA_STREAM, (uint32_t)data, DMA_Memory_0);
+  DMA_SetCurrDataCounter(USARTx_TX_DMA_STREAM, len);
+  DMA_Cmd(USARTx_TX_DMA_STREAM, ENABLE);
+  txStarted = 1;
+  return PASSED;
+}
+
+void USART_DMA_SetBaudrate(uint32_t baudrate)
+{
+  // let the last byte leave the shift register before changing the clock;
+  // TC was cleared at enable and only sets again after a transfer, so nothing to wait for before the first one
+  while (USART_DMA_TxBusy());
+  while (txStarted && USART_GetFlagStatus(USARTx, USART_FLAG_TC) == RESET);
+  USART_Cmd(USARTx, DISABLE);
+  USART_Setup(baudrate);
+  USART_Cmd(USARTx, ENABLE);
+}
+
+void USART_DMA_RxComplete(void)
+{
+  rxGen++;
+}
+
+uint8_t USART_DMA_RxIdle(void)
+{
+  if (USART_GetFlagStatus(USARTx, USART_FLAG_IDLE) == RESET) return 0;
+  // cleared by reading SR then DR; the DMA already took the last byte
+  (void)USART_ReceiveData(USARTx);
+  return 1;
+}
+
+// Total number of bytes written by the DMA since start (modulo 2^32)
+static uint32_t USART_DMA_Written(void)
+{
+  uint32_t gen, writePos;
+  do {
+    gen = rxGen;
+    // NDTR counts down the bytes left in the current buffer
+    writePos = rxBufferSize - DMA_GetCurrDataCounter(USARTx_RX_DMA_STREAM);
+  } while (gen != rxGen);
+  if (writePos >= rxBufferSize) writePos = 0;
+
+  uint32_t written = gen * rxBufferSize + writePos;
+  // NDTR already reloaded but the TC interrupt has not run yet
+  if ((int32_t)(written - rxTotalRead) < 0) written += rxBufferSize;
+  return written;
+}
+
+static uint32_t USART_DMA_Capacity(void)
+{
+  return rxDoubleBuffer ? 2 * rxBufferSize : rxBufferSize;
+}
+
+static void USART_DMA_Advance(uint32_t n)
+{
+  rxTotalRead += n;
+  rxReadPos += n;
+  if (rxReadPos >= rxBufferSize) {
+    uint32_t segments = rxReadPos / rxBufferSize;
+    rxReadPos -= segments * rxBufferSize;
+    if (rxDoubleBuffer && (segments & 1)) rxReadSeg ^= 1;
+  }
+}
+
+uint32_t USART_DMA_Peek(const uint8_t **data)
+{
+  uint32_t unread = USART_DMA_Written() - rxTotalRead;
+  if (unread > USART_DMA_Capacity()) {
+    // the DMA lapped the reader: the unread bytes are already overwritten, restart at the write position
+    usartDmaStats.missed++;
+    USART_DMA_Advance(unread);
+    unread = 0;
+  }
+  uint32_t contiguous = rxBufferSize - rxReadPos;
+  *data = (const uint8_t *)&rxBuffers[rxReadSeg][rxReadPos];
+  return unread < contiguous ? unread : contiguous;
+}
+
+TestStatus USART_DMA_Consume(uint32_t n)
+{
+  uint32_t start = rxTotalRead;
+  USART_DMA_Advance(n);
+  // the DMA came back to the oldest byte before the consumer was done with it
+  if (USART_DMA_Written() - start > USART_DMA_Capacity()) {
+    usartDmaStats.torn++;
+    return FAILED;
+  }
+  return PASSED;
+}
+
+uint32_t USART_DMA_Read(uint8_t *dst, uint32_t maxLen)
+{
+  uint32_t n = 0;
+  const uint8_t *data;
+  uint32_t len;
+  while (n < maxLen && (len = USART_DMA_Peek(&data)) > 0) {
+    if (len > maxLen - n) len = maxLen - n;
+    for (uint32_t i = 0; i < len; i++) dst[n + i] = data[i];
+    n += len;
+    USART_DMA_Consume(len);
+  }
+  return n;
+}
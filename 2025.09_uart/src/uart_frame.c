@@ -0,0 +1,182 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_frame.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "uart_frame.h"
+
+uint16_t uart_frame_crc16(uint16_t crc, const uint8_t *data, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (int b = 0; b < 8; b++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+void uart_frame_parser_init(uart_frame_parser_t *parser)
+{
+  memset(parser, 0, sizeof(uart_frame_parser_t));
+}
+
+// Drop the leading byte and everything up to the next sync candidate.
+// The buffer never holds more than one frame, so this is bounded by UART_FRAME_MAX_SIZE.
+static void parser_resync(uart_frame_parser_t *parser)
+{
+  uint32_t skip = 1;
+  while (skip < parser->len && parser->buf[skip] != UART_FRAME_SYNC0) {
+    skip++;
+  }
+  if (!parser->hunting) {
+    parser->stats.resyncs++;
+    parser->hunting = true;
+  }
+  parser->stats.bytes_dropped += skip;
+  parser->len -= skip;
+  memmove(parser->buf, &parser->buf[skip], parser->len);
+}
+
+static void parser_deliver(uart_frame_parser_t *parser, uint32_t frame_size,
+                           uart_frame_handler_t handler, void *ctx)
+{
+  uart_frame_t *frame = &parser->frame;
+  frame->len = parser->buf[2];
+  frame->msg_id = parser->buf[3];
+  frame->seq = parser->buf[4];
+  memcpy(frame->payload, &parser->buf[UART_FRAME_HEADER_SIZE], frame->len);
+
+  if (parser->has_seq) {
+    parser->stats.seq_gaps += (uint8_t)(frame->seq - parser->last_seq - 1);
+  }
+  parser->last_seq = frame->seq;
+  parser->has_seq = true;
+  parser->hunting = false;
+  parser->stats.frames++;
+
+  parser->len -= frame_size;
+  memmove(parser->buf, &parser->buf[frame_size], parser->len);
+
+  if (handler) {
+    handler(frame, ctx);
+  }
+}
+
+static void parser_push(uart_frame_parser_t *parser, uint8_t byte,
+                        uart_frame_handler_t handler, void *ctx)
+{
+  if (parser->len == 0 && byte != UART_FRAME_SYNC0) {
+    // nothing buffered: discard without copying
+    if (!parser->hunting) {
+      parser->stats.resyncs++;
+      parser->hunting = true;
+    }
+    parser->stats.bytes_dropped++;
+    return;
+  }
+  parser->buf[parser->len++] = byte;
+
+  // re-examine the buffered bytes until a frame is missing data
+  while (parser->len > 0) {
+    if (parser->buf[0] != UART_FRAME_SYNC0) {
+      parser_resync(parser);
+      continue;
+    }
+    if (parser->len < 2) break;
+    if (parser->buf[1] != UART_FRAME_SYNC1) {
+      parser_resync(parser);
+      continue;
+    }
+    if (parser->len < UART_FRAME_HEADER_SIZE) break;
+
+    uint32_t payload_len = parser->buf[2];
+    if (payload_len > UART_FRAME_MAX_PAYLOAD) {
+      parser->stats.len_errors++;
+      parser_resync(parser);
+      continue;
+    }
+    uint32_t frame_size = UART_FRAME_OVERHEAD + payload_len;
+    if (parser->len < frame_size) break;
+
+    uint16_t crc = uart_frame_crc16(0xFFFF, &parser->buf[2], UART_FRAME_HEADER_SIZE - 2 + payload_len);
+    uint16_t rx_crc = (uint16_t)parser->buf[frame_size - 2] | ((uint16_t)parser->buf[frame_size - 1] << 8);
+    if (crc != rx_crc) {
+      parser->stats.crc_errors++;
+      parser_resync(parser);
+      continue;
+    }
+    parser_deliver(parser, frame_size, handler, ctx);
+  }
+}
+
+void uart_frame_parse(uart_frame_parser_t *parser, const uint8_t *data, uint32_t len,
+                      uart_frame_handler_t handler, void *ctx)
+{
+  for (uint32_t i = 0; i < len; i++) {
+    parser_push(parser, data[i], handler, ctx);
+  }
+}
+
+uint32_t uart_frame_encode(uint8_t *out, uint32_t out_size, uint8_t msg_id, uint8_t seq,
+                           const uint8_t *payload, uint8_t len)
+{
+  uint32_t frame_size = UART_FRAME_OVERHEAD + len;
+  if (len > UART_FRAME_MAX_PAYLOAD || frame_size > out_size) {
+    return 0;
+  }
+  out[0] = UART_FRAME_SYNC0;
+  out[1] = UART_FRAME_SYNC1;
+  out[2] = len;
+  out[3] = msg_id;
+  out[4] = seq;
+  memcpy(&out[UART_FRAME_HEADER_SIZE], payload, len);
+  uint16_t crc = uart_frame_crc16(0xFFFF, &out[2], UART_FRAME_HEADER_SIZE - 2 + len);
+  out[frame_size - 2] = (uint8_t)(crc & 0xFF);
+  out[frame_size - 1] = (uint8_t)(crc >> 8);
+  return frame_size;
+}
+
+uint8_t uart_frame_unpack_outputs(const uart_frame_t *frame, int32_t *out, uint8_t max_outputs)
+{
+  uint8_t width;
+  switch (frame->msg_id) {
+    case UART_MSG_INFERENCE:     width = 4; break;
+    case UART_MSG_INFERENCE_Q16: width = 2; break;
+    case UART_MSG_INFERENCE_Q8:  width = 1; break;
+    default: return 0;
+  }
+  if (frame->len % width != 0 || frame->len / width > max_outputs) {
+    return 0;
+  }
+  uint8_t n = frame->len / width;
+  const uint8_t *p = frame->payload;
+  for (uint8_t i = 0; i < n; i++, p += width) {
+    if (width == 4) {
+      out[i] = (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+    } else if (width == 2) {
+      out[i] = (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+    } else {
+      out[i] = (int8_t)p[0];
+    }
+  }
+  return n;
+}
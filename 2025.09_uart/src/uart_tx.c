@@ -0,0 +1,71 @@
+/*-----------------------------------------------------------------------------
+ Copyright (C) 2024 University of Bologna, Italy, ETH Zurich, Switzerland.
+ All rights reserved.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ See LICENSE in the top directory for details.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+
+ File:    uart_tx.c
+ Author:  Lorenzo Lamberti      <lorenzo.lamberti@unibo.it>
+ Date:    01.03.2024
+-------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "uart_tx.h"
+#include "uart_frame.h"
+
+void uart_tx_init(uart_tx_t *tx, const uart_tx_io_t *io)
+{
+  memset(tx, 0, sizeof(uart_tx_t));
+  tx->io = *io;
+}
+
+bool uart_tx_frame(uart_tx_t *tx, uint8_t msg_id, const void *payload, uint8_t len)
+{
+  uint8_t *dst = &tx->batch[tx->fill_idx][tx->fill_len];
+  uint32_t n = uart_frame_encode(dst, UART_TX_BATCH_SIZE - tx->fill_len, msg_id, tx->seq,
+                                 (const uint8_t *)payload, len);
+  if (n == 0) {
+    tx->frames_dropped++;
+    return false;
+  }
+  tx->seq++;
+  tx->fill_len += n;
+  tx->frames_queued++;
+  return true;
+}
+
+void uart_tx_poll(uart_tx_t *tx, uint32_t now_ms)
+{
+  if (tx->flight_len > 0 && !tx->io.busy(tx->io.ctx)) {
+    tx->bytes_sent += tx->flight_len;
+    tx->window_bytes += tx->flight_len;
+    tx->flight_len = 0;
+  }
+
+  // swap batches: the DMA reads one while the app fills the other
+  if (tx->flight_len == 0 && tx->fill_len > 0) {
+    if (tx->io.start(tx->batch[tx->fill_idx], tx->fill_len, tx->io.ctx)) {
+      tx->flight_len = tx->fill_len;
+      tx->fill_len = 0;
+      tx->fill_idx ^= 1;
+    }
+  }
+
+  tx->depth = tx->fill_len + tx->flight_len;
+  if (now_ms - tx->t_window >= 1000) {
+    tx->bytes_per_sec = tx->window_bytes * 1000 / (now_ms - tx->t_window);
+    tx->window_bytes = 0;
+    tx->t_window = now_ms;
+  }
+}
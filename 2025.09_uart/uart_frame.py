@@ -0,0 +1,170 @@
+"""Host-side implementation of the AI-deck UART framing (see inc/uart_frame.h).
+
+| 0xA5 | 0x5A | len | msg_id | seq | payload[len] | crc16 (LE) |
+"""
+import struct
+
+SYNC0 = 0xA5
+SYNC1 = 0x5A
+HEADER_SIZE = 5
+CRC_SIZE = 2
+MAX_PAYLOAD = 64
+OVERHEAD = HEADER_SIZE + CRC_SIZE
+
+MSG_INFERENCE = 0x01
+MSG_INFERENCE_Q8 = 0x02
+MSG_INFERENCE_Q16 = 0x03
+MSG_QUANT_HEADER = 0x04
+MSG_TENSOR = 0x05
+MSG_QUANT_TABLE = 0x06
+MSG_NET_COMMAND = 0x07
+MSG_BAUD_REQ = 0x10
+MSG_BAUD_ACK = 0x11
+MSG_STATE = 0x20
+MSG_LINK_STATS = 0x21
+MSG_DEBUG_TEXT = 0x30
+MSG_CONFIG_ACK = 0x31
+MSG_TIMING_PROBE = 0x32
+
+# uart_state_msg_t: timestamp [ms], vx, vy, vz [m/s], z [m], yaw [deg], ranges front/back/left/right/up [mm]
+STATE_FORMAT = "<I5f5H"
+# uart_link_stats_msg_t: frames, crc_errors, resyncs, bytes_dropped, seq_gaps, queue_overflows, latency_max [us]
+LINK_STATS_FORMAT = "<7I"
+# uart_timing_msg_t: t_deck, t_rx, t_tx [us]
+TIMING_FORMAT = "<3I"
+# uart_quant_msg_t: scale, zero_point -- output = (q - zero_point) * scale
+QUANT_FORMAT = "<fh"
+# uart_net_command_msg_t: net_id, confidence (255 = 1), steering (Q15), speed (65535 = 1), latency [ms]
+NET_COMMAND_FORMAT = "<BBhHH"
+
+# uart_tensor_chunk_t: tensor_id, frame, offset [byte], followed by the chunk data
+TENSOR_CHUNK_FORMAT = "<BBH"
+TENSOR_CHUNK_MAX = MAX_PAYLOAD - struct.calcsize(TENSOR_CHUNK_FORMAT)
+
+# inference frame formats: message id, struct code of one output
+INFERENCE_FORMATS = {
+    "int32": (MSG_INFERENCE, "i"),
+    "q16": (MSG_INFERENCE_Q16, "h"),
+    "q8": (MSG_INFERENCE_Q8, "b"),
+}
+
+BAUD_BASE = 115200
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def pack_frame(msg_id, seq, payload):
+    body = struct.pack("<BBB", len(payload), msg_id, seq & 0xFF) + payload
+    return bytes([SYNC0, SYNC1]) + body + struct.pack("<H", crc16_ccitt(body))
+
+
+def quantize(values, scale, zero_point, code):
+    """Round floats to the integer type of struct code, saturating.
+    scale and zero_point are shared, or lists with one entry per value."""
+    bits = 8 * struct.calcsize(code) - 1
+    lo, hi = -(1 << bits), (1 << bits) - 1
+    n = len(values)
+    scales = scale if isinstance(scale, (list, tuple)) else [scale] * n
+    zero_points = zero_point if isinstance(zero_point, (list, tuple)) else [zero_point] * n
+    return [min(hi, max(lo, round(v / s) + z)) for v, s, z in zip(values, scales, zero_points)]
+
+
+def pack_inference(fmt, seq, values, scale, zero_point=0):
+    """Frame float outputs as int32, q16 or q8."""
+    msg_id, code = INFERENCE_FORMATS[fmt]
+    q = quantize(values, scale, zero_point, code)
+    return pack_frame(msg_id, seq, struct.pack("<%d%s" % (len(q), code), *q))
+
+
+def pack_quant_table(seq, entries, first=0):
+    """UART_MSG_QUANT_TABLE for outputs first.., entries = [(scale, zero_point), ...]."""
+    payload = struct.pack("<B", first) + b"".join(struct.pack(QUANT_FORMAT, s, z) for s, z in entries)
+    return pack_frame(MSG_QUANT_TABLE, seq, payload)
+
+
+def pack_net_command(seq, net_id, steering, speed, confidence=1.0, latency_ms=0):
+    """UART_MSG_NET_COMMAND: command proposed by an auxiliary network."""
+    q = lambda x, full: int(round(min(1.0, max(0.0, x)) * full))
+    steer = int(round(min(1.0, max(-1.0, steering)) * 32767))
+    payload = struct.pack(NET_COMMAND_FORMAT, net_id, q(confidence, 255), steer, q(speed, 65535), latency_ms)
+    return pack_frame(MSG_NET_COMMAND, seq, payload)
+
+
+def pack_tensor(tensor_id, frame, data, seq):
+    """Split a tensor into UART_MSG_TENSOR frames; returns (frames, next seq)."""
+    frames = []
+    for offset in range(0, len(data), TENSOR_CHUNK_MAX):
+        chunk = struct.pack(TENSOR_CHUNK_FORMAT, tensor_id, frame & 0xFF, offset) + data[offset:offset + TENSOR_CHUNK_MAX]
+        frames.append(pack_frame(MSG_TENSOR, seq, chunk))
+        seq += 1
+    return frames, seq
+
+
+class FrameParser:
+    """Same resynchronization rules and counters as uart_frame.c."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.hunting = False
+        self.last_seq = None
+        self.frames = 0
+        self.crc_errors = 0
+        self.len_errors = 0
+        self.resyncs = 0
+        self.bytes_dropped = 0
+        self.seq_gaps = 0
+
+    def _resync(self):
+        skip = 1
+        while skip < len(self.buf) and self.buf[skip] != SYNC0:
+            skip += 1
+        if not self.hunting:
+            self.resyncs += 1
+            self.hunting = True
+        self.bytes_dropped += skip
+        del self.buf[:skip]
+
+    def feed(self, data):
+        """Return the list of (msg_id, seq, payload) decoded from data."""
+        frames = []
+        self.buf += data
+        while self.buf:
+            if self.buf[0] != SYNC0:
+                self._resync()
+                continue
+            if len(self.buf) < 2:
+                break
+            if self.buf[1] != SYNC1:
+                self._resync()
+                continue
+            if len(self.buf) < HEADER_SIZE:
+                break
+            length = self.buf[2]
+            if length > MAX_PAYLOAD:
+                self.len_errors += 1
+                self._resync()
+                continue
+            size = OVERHEAD + length
+            if len(self.buf) < size:
+                break
+            (crc,) = struct.unpack_from("<H", self.buf, size - CRC_SIZE)
+            if crc != crc16_ccitt(self.buf[2:size - CRC_SIZE]):
+                self.crc_errors += 1
+                self._resync()
+                continue
+            msg_id, seq = self.buf[3], self.buf[4]
+            if self.last_seq is not None:
+                self.seq_gaps += (seq - self.last_seq - 1) & 0xFF
+            self.last_seq = seq
+            self.hunting = False
+            self.frames += 1
+            frames.append((msg_id, seq, bytes(self.buf[HEADER_SIZE:size - CRC_SIZE])))
+            del self.buf[:size]
+        return frames